@@ -0,0 +1,8 @@
+#pragma once
+
+class CommandLine
+{
+public:
+  static bool isBatchInvocation(int argc, char* argv[]);
+  static int run(int argc, char* argv[]);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "Occt/MeshTypes.h"
+
+class QJsonObject;
+class QLocalServer;
+class QLocalSocket;
+
+struct ConversionServerOptions
+{
+  int maxConcurrentJobs = 0;
+  int maxQueuedJobs = 64;
+  qint64 meshCacheBytes = 1024LL * 1024 * 1024;
+  // Longest request line a client may send before the connection is dropped.
+  int maxRequestBytes = 1024 * 1024;
+};
+
+class ConversionServer final : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ConversionServer(const ConversionServerOptions& options, QObject* parent = nullptr);
+  ~ConversionServer() override;
+
+  bool listen(const QString& socketName, QString* errorText);
+
+  std::shared_ptr<const TriMesh> cachedMesh(const QString& key);
+  void storeMesh(const QString& key, const std::shared_ptr<const TriMesh>& mesh);
+
+private:
+  void acceptConnections();
+  void readRequests(QLocalSocket* socket);
+  void submitJob(QLocalSocket* socket, const QJsonObject& request);
+  void finishJob(QLocalSocket* socket, const QJsonObject& reply);
+  static void writeReply(QLocalSocket* socket, const QJsonObject& reply);
+
+  struct CacheEntry
+  {
+    QString key;
+    std::shared_ptr<const TriMesh> mesh;
+    qint64 bytes = 0;
+  };
+
+  ConversionServerOptions m_options;
+  QLocalServer* m_server = nullptr;
+  QThreadPool m_pool;
+  QHash<QLocalSocket*, QByteArray> m_pendingInput;
+  int m_jobsInFlight = 0;
+
+  std::mutex m_cacheMutex;
+  std::list<CacheEntry> m_cacheLru;
+  qint64 m_cacheBytes = 0;
+};
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QMainWindow>
+#include <QStringList>
 
 class QAction;
+class QLabel;
 
 class OcctViewerWidget;
 
@@ -19,11 +21,27 @@ private:
   void connectSignals();
 
   void importIgs();
+  void onPartLoaded(const QString& filePath, bool ok, const QString& errorText);
+  void onSceneLoadFinished(int loadedCount, int failedCount, qint64 elapsedMs);
+  void importMesh();
   void exportObj();
+  void exportCompressed();
+  void configureMemoryBudget();
+  void configureMeshing();
+  void showExportResult(const QString& filePath);
 
   OcctViewerWidget* m_viewer = nullptr;
 
   QAction* m_importIgsAction = nullptr;
+  QAction* m_importMeshAction = nullptr;
   QAction* m_exportObjAction = nullptr;
+  QAction* m_exportCompressedAction = nullptr;
+  QAction* m_healAction = nullptr;
+  QAction* m_memoryBudgetAction = nullptr;
+  QAction* m_meshingAction = nullptr;
+  QAction* m_exportQuadsAction = nullptr;
   QAction* m_exitAction = nullptr;
+  QLabel* m_hoverLabel = nullptr;
+
+  QStringList m_loadErrors;
 };
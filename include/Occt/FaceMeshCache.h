@@ -0,0 +1,136 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Poly_Triangulation.hxx>
+#include <TopAbs_Orientation.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_TShape.hxx>
+
+#include "Occt/MeshTypes.h"
+
+struct FaceMeshStats
+{
+  int faceCount = 0;
+  int triangulatedFaces = 0;
+  int weldedFaces = 0;
+  int pairedFaces = 0;
+  qint64 elapsedMs = 0;
+};
+
+// Per-face meshing results, keyed by face TShape and the parameters each stage depends on:
+// triangulation by the deflections, the face-local weld additionally by location and weld tolerance,
+// quad candidates by the weld they came from. Builds only run the missing per-face stages before the
+// global merge, so switching between export settings does not re-mesh faces that are already known.
+class FaceMeshCache
+{
+public:
+  // Records the triangulations already on shape's faces as the result of meshing with params.
+  void adoptTriangulations(const TopoDS_Shape& shape, const MeshingParams& params);
+
+  std::shared_ptr<TriMesh> buildTriMesh(const TopoDS_Shape& shape, const MeshingParams& params,
+                                        FaceMeshStats* stats = nullptr);
+  std::shared_ptr<QuadMesh> buildQuadMesh(const TopoDS_Shape& shape, const MeshingParams& params,
+                                          FaceMeshStats* stats = nullptr);
+
+  void clear() { m_faces.clear(); }
+  bool isEmpty() const { return m_faces.empty(); }
+  qint64 memoryBytes() const;
+
+  struct WeldKey
+  {
+    long long x = 0;
+    long long y = 0;
+    long long z = 0;
+    bool operator==(const WeldKey& o) const { return x == o.x && y == o.y && z == o.z; }
+  };
+
+  struct WeldKeyHash
+  {
+    size_t operator()(const WeldKey& k) const noexcept
+    {
+      const size_t hx = static_cast<size_t>(k.x) * 73856093ULL;
+      const size_t hy = static_cast<size_t>(k.y) * 19349663ULL;
+      const size_t hz = static_cast<size_t>(k.z) * 83492791ULL;
+      return hx ^ hy ^ hz;
+    }
+  };
+
+  // Face-local buffers in world coordinates, before the face orientation is applied.
+  struct WeldedFace
+  {
+    std::vector<gp_Pnt> vertices;
+    std::vector<WeldKey> keys;
+    std::vector<int> triangles;
+  };
+
+  // Triangle pairs inside one face that pass the flatness test; indices are local to the WeldedFace.
+  // sharedA -> sharedB follows the winding of t0.
+  struct QuadCandidate
+  {
+    int t0 = -1;
+    int t1 = -1;
+    int sharedA = -1;
+    int sharedB = -1;
+    int other0 = -1;
+    int other1 = -1;
+  };
+
+private:
+  struct TriangulationVariant
+  {
+    double linearDeflection = 0.0;
+    double angularDeflection = 0.0;
+    Handle(Poly_Triangulation) triangulation;
+  };
+
+  struct InstanceWeld
+  {
+    TopLoc_Location location;
+    std::shared_ptr<const WeldedFace> welded;
+    std::shared_ptr<const std::vector<QuadCandidate>> candidates;
+  };
+
+  // Every instance of a face is welded in its own location; a parameter set keeps all of them so that
+  // eviction never drops a weld that the current build still needs.
+  struct WeldVariant
+  {
+    MeshingParams params;
+    std::vector<InstanceWeld> instances;
+  };
+
+  struct FaceRecord
+  {
+    Handle(TopoDS_TShape) tshape;
+    TopoDS_Face face;
+    std::vector<TriangulationVariant> triangulations;
+    std::vector<WeldVariant> welds;
+  };
+
+  struct FaceUse
+  {
+    FaceRecord* record = nullptr;
+    TopLoc_Location location;
+    TopAbs_Orientation orientation = TopAbs_FORWARD;
+    std::shared_ptr<const WeldedFace> welded;
+    std::shared_ptr<const std::vector<QuadCandidate>> candidates;
+  };
+
+  std::vector<FaceUse> prepareFaces(const TopoDS_Shape& shape, const MeshingParams& params, bool withCandidates,
+                                    FaceMeshStats& stats);
+  FaceRecord& recordFor(const TopoDS_Face& face);
+  static const TriangulationVariant* findTriangulation(const FaceRecord& record, const MeshingParams& params);
+  static InstanceWeld* findWeld(FaceRecord& record, const TopLoc_Location& location, const MeshingParams& params);
+  static void storeWeld(FaceRecord& record, const TopLoc_Location& location, const MeshingParams& params,
+                        const std::shared_ptr<const WeldedFace>& welded);
+  static void mergeFaces(const std::vector<FaceUse>& uses, std::vector<gp_Pnt>& vertices,
+                         std::vector<std::vector<int>>& remaps);
+
+  std::unordered_map<const TopoDS_TShape*, FaceRecord> m_faces;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QRunnable>
+
+#include <functional>
+#include <utility>
+
+// QThreadPool job wrapping a callable; QThreadPool::start(std::function) is not available on older Qt 5.
+class FunctionJob final : public QRunnable
+{
+public:
+  explicit FunctionJob(std::function<void()> fn)
+    : m_fn(std::move(fn))
+  {
+  }
+
+  void run() override { m_fn(); }
+
+private:
+  std::function<void()> m_fn;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "Occt/MeshTypes.h"
+
+// Per-load accounting of the bytes each pipeline stage holds. Not thread-safe: one load owns one budget.
+class MemoryBudget
+{
+public:
+  struct Stage
+  {
+    QString name;
+    qint64 bytes = 0;
+    qint64 peakBytes = 0;
+  };
+
+  // Stage names shared by everything that records into a budget; they also label the summary.
+  static constexpr const char* kStageFaceTriangulations = "面三角化";
+  static constexpr const char* kStageWeldArena = "焊接临时表";
+  static constexpr const char* kStageTriMesh = "三角网格";
+  static constexpr const char* kStageQuadArena = "四边形临时表";
+  static constexpr const char* kStageQuadMesh = "四边形网格";
+  static constexpr const char* kStageFaceCache = "面网格缓存";
+  static constexpr const char* kStageDisplayMesh = "显示网格";
+  static constexpr const char* kStagePickBvh = "拾取 BVH";
+
+  explicit MemoryBudget(qint64 limitBytes = 0)
+    : m_limitBytes(limitBytes)
+  {
+  }
+
+  bool isLimited() const { return m_limitBytes > 0; }
+  qint64 limitBytes() const { return m_limitBytes; }
+  qint64 usedBytes() const;
+  qint64 peakBytes() const { return m_peakBytes; }
+
+  bool fits(qint64 extraBytes) const;
+  bool check(const QString& what, qint64 extraBytes, QString* errorText) const;
+
+  void record(const QString& stage, qint64 bytes);
+  void release(const QString& stage) { record(stage, 0); }
+  void clear();
+
+  const std::vector<Stage>& stages() const { return m_stages; }
+  QString summary() const;
+
+  static qint64 bytesOf(const TriMesh& mesh);
+  static qint64 bytesOf(const QuadMesh& mesh);
+
+private:
+  qint64 m_limitBytes = 0;
+  qint64 m_peakBytes = 0;
+  std::vector<Stage> m_stages;
+};
+
+// Upstream for per-load arenas: counts what the arena took from the heap so the stage can be recorded,
+// while std::pmr::monotonic_buffer_resource hands everything back in one release().
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+  size_t allocatedBytes() const { return m_bytes; }
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    m_bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override
+  {
+    m_bytes -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  size_t m_bytes = 0;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+
+#include <memory>
+
+#include <TopoDS_Shape.hxx>
+
+#include "Occt/MeshTypes.h"
+
+class MemoryBudget;
+
+class MeshBuilder
+{
+public:
+  static void warmUp();
+  static bool readIgsFile(const QString& filePath, TopoDS_Shape& shape, QString* errorText);
+  static std::shared_ptr<TriMesh> buildTriMesh(const TopoDS_Shape& shape, const MeshingParams& params = MeshingParams());
+  static std::shared_ptr<QuadMesh> buildQuadMesh(const TriMesh& triMesh);
+  // The triangulations already on shape's faces, concatenated without welding: every face keeps its own
+  // nodes. Enough for ray casts and distance queries, at a fraction of the cost of buildTriMesh.
+  static std::shared_ptr<TriMesh> collectTriangles(const TopoDS_Shape& shape);
+  // Bytes held by the triangulations on shape's faces, counting a triangulation shared by instances once.
+  static qint64 triangulationBytes(const TopoDS_Shape& shape);
+
+  // Budgeted variants: record per-stage bytes in budget and return nullptr (with errorText) instead of
+  // starting a stage whose estimate would exceed it. The face triangulations stay on the shape and are
+  // not recorded here; the caller owns them and accounts them with triangulationBytes().
+  static std::shared_ptr<TriMesh> buildTriMesh(const TopoDS_Shape& shape, const MeshingParams& params,
+                                               MemoryBudget* budget, QString* errorText);
+  static std::shared_ptr<QuadMesh> buildQuadMesh(const TriMesh& triMesh, MemoryBudget* budget, QString* errorText);
+
+  // Whether the triangles (sharedA, sharedB, other0) and (sharedB, sharedA, other1) form a flat quad.
+  static bool canMergeTriangles(const gp_Pnt& sharedA, const gp_Pnt& sharedB, const gp_Pnt& other0,
+                                const gp_Pnt& other1);
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+
+struct TriMesh;
+
+struct MeshRay
+{
+  gp_Pnt origin;
+  gp_Dir direction;
+};
+
+struct MeshQueryHit
+{
+  int triangle = -1;
+  double distance = 0.0;
+  gp_Pnt point;
+
+  bool isValid() const { return triangle >= 0; }
+};
+
+class MeshBvh
+{
+public:
+  void build(const TriMesh& mesh);
+  void clear();
+
+  bool isEmpty() const { return m_nodes.empty(); }
+  size_t triangleCount() const { return m_triIds.size(); }
+  size_t nodeCount() const { return m_nodes.size(); }
+  size_t memoryBytes() const;
+
+  bool bounds(gp_Pnt& minPnt, gp_Pnt& maxPnt) const;
+
+  MeshQueryHit rayCast(const MeshRay& ray, double maxDistance = std::numeric_limits<double>::infinity()) const;
+  MeshQueryHit closestPoint(const gp_Pnt& p, double maxDistance = std::numeric_limits<double>::infinity()) const;
+  void trianglesInBox(const gp_Pnt& minPnt, const gp_Pnt& maxPnt, std::vector<int>& triangles) const;
+
+  std::vector<MeshQueryHit> rayCastBatch(const std::vector<MeshRay>& rays,
+                                         double maxDistance = std::numeric_limits<double>::infinity()) const;
+  std::vector<MeshQueryHit> closestPointBatch(const std::vector<gp_Pnt>& points,
+                                              double maxDistance = std::numeric_limits<double>::infinity()) const;
+
+private:
+  // 32 bytes: interior nodes store the index of their first child (the second one follows it),
+  // leaves store the first packed triangle and a non-zero triangle count.
+  struct alignas(16) Node
+  {
+    float bmin[3];
+    int32_t leftOrFirst;
+    float bmax[3];
+    int32_t count;
+  };
+
+  struct PackedTri
+  {
+    float v0[3];
+    float e1[3];
+    float e2[3];
+  };
+
+  struct Builder;
+
+  std::vector<Node> m_nodes;
+  std::vector<PackedTri> m_tris;
+  std::vector<int> m_triIds;
+};
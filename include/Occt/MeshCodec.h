@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <cstddef>
+
+struct TriMesh;
+
+class MeshCodec
+{
+public:
+  static constexpr int kDefaultPositionBits = 20;
+  // Range offered to users; below 8 bits the quantization error is visible at any model size.
+  static constexpr int kMinPositionBits = 8;
+  static constexpr int kMaxPositionBits = 31;
+
+  static QByteArray encode(const TriMesh& mesh, int positionBits = kDefaultPositionBits);
+  static bool decode(const char* data, size_t size, TriMesh& mesh, QString* errorText);
+
+  static bool writeFile(const QString& filePath, const TriMesh& mesh, int positionBits, QString* errorText);
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+struct TriMesh;
+
+class MeshRasterizer
+{
+public:
+  // Largest width or height accepted; a square image this size is already 1 GiB of pixels plus its depth buffer.
+  static constexpr int kMaxImageSize = 16384;
+
+  static QImage render(const TriMesh& mesh, int width, int height);
+  static bool renderToPng(const QString& filePath, const TriMesh& mesh, int width, int height, QString* errorText);
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <QString>
+
+struct TriMesh;
+
+class MeshReader
+{
+public:
+  static bool readFile(const QString& filePath, TriMesh& mesh, QString* errorText);
+};
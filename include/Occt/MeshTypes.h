@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include <gp_Pnt.hxx>
@@ -17,3 +19,19 @@ struct QuadMesh
   std::vector<int> triIndices;
 };
 
+struct MeshingParams
+{
+  double linearDeflection = 0.5;
+  double angularDeflection = 0.5;
+  double weldTolerance = 1e-6;
+
+  // Values that went through a dialog or text round-trip may differ in the last bits; those still match.
+  static bool sameValue(double a, double b) { return std::abs(a - b) <= 1e-9 * std::max(std::abs(a), std::abs(b)); }
+
+  bool operator==(const MeshingParams& o) const
+  {
+    return sameValue(linearDeflection, o.linearDeflection) && sameValue(angularDeflection, o.angularDeflection)
+           && sameValue(weldTolerance, o.weldTolerance);
+  }
+  bool operator!=(const MeshingParams& o) const { return !(*this == o); }
+};
@@ -1,15 +1,24 @@
 #pragma once
 
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThreadPool>
 #include <QWidget>
 
 #include <memory>
+#include <vector>
 
 #include <Standard_Handle.hxx>
 #include <TopoDS_Shape.hxx>
 
+#include "Occt/FaceMeshCache.h"
+#include "Occt/MemoryBudget.h"
 #include "Occt/MeshTypes.h"
+#include "Occt/ShapeHealer.h"
 
+class MeshBvh;
 class AIS_InteractiveContext;
+class AIS_Shape;
 class V3d_Viewer;
 class V3d_View;
 class QPaintEngine;
@@ -22,8 +31,33 @@ public:
   explicit OcctViewerWidget(QWidget* parent = nullptr);
   ~OcctViewerWidget() override;
 
-  bool loadIgsFile(const QString& filePath, QString* errorText = nullptr);
+  void setHealingEnabled(bool enabled) { m_healingEnabled = enabled; }
+  bool healingEnabled() const { return m_healingEnabled; }
+  const HealingReport& lastHealingReport() const { return m_lastHealingReport; }
+
+  // Later exports re-mesh only the faces and stages the new parameters affect.
+  void setMeshingParams(const MeshingParams& params);
+  const MeshingParams& meshingParams() const { return m_meshingParams; }
+  const FaceMeshStats& lastMeshStats() const { return m_lastMeshStats; }
+
+  // 0 disables the limit; stage sizes are tracked either way.
+  void setMemoryBudget(qint64 limitBytes);
+  const MemoryBudget& memoryBudget() const { return m_memoryBudget; }
+
+  // Replaces the scene and reads the files concurrently; each one is displayed as it finishes.
+  void loadIgsFiles(const QStringList& filePaths);
+  bool isLoading() const { return m_pendingLoads > 0; }
+  // Index into the loaded parts of the clicked part, or -1 when exports cover the whole scene.
+  int selectedPartIndex() const;
+  bool loadMeshFile(const QString& filePath, QString* errorText = nullptr);
   bool exportObjFile(const QString& filePath, bool exportQuads, QString* errorText = nullptr);
+  bool exportCompressedFile(const QString& filePath, int positionBits, QString* errorText = nullptr);
+
+signals:
+  void hoverPointChanged(bool hasHit, double x, double y, double z);
+  void partLoaded(const QString& filePath, bool ok, const QString& errorText);
+  void sceneLoadFinished(int loadedCount, int failedCount, qint64 elapsedMs);
+  void selectionChanged(const QString& filePath);
 
 protected:
   QPaintEngine* paintEngine() const override;
@@ -41,7 +75,23 @@ private:
   void redraw();
 
   bool buildTriangulation(bool buildQuads, QString* errorText);
-  void displayShape();
+  std::shared_ptr<TriMesh> meshShape(const TopoDS_Shape& shape, MemoryBudget& budget, QString* errorText);
+  std::shared_ptr<QuadMesh> quadMeshShape(const TopoDS_Shape& shape, const TriMesh& triMesh, MemoryBudget& budget,
+                                          QString* errorText);
+  MemoryBudget budgetForSelectedPart() const;
+  std::shared_ptr<TriMesh> buildSelectedPartMesh(int partIndex, MemoryBudget& budget, QString* errorText);
+  void addScenePart(const QString& filePath, const TopoDS_Shape& shape, const MeshingParams& meshedWith,
+                    const std::shared_ptr<const MeshBvh>& pickBvh);
+  void finishPartLoad(int generation, const QString& filePath, bool ok, const TopoDS_Shape& shape,
+                      const MeshingParams& meshedWith, const std::shared_ptr<const MeshBvh>& pickBvh,
+                      const HealingReport& report, const QString& errorText);
+  void addPickAccelerator(const std::shared_ptr<const MeshBvh>& bvh);
+  qint64 pickMemoryBytes() const;
+  qint64 displayTriangulationBytes() const;
+  void selectAt(const QPoint& pos);
+  void displayTriMesh();
+  void updateHoverPick(const QPoint& pos);
+  void resetModelData();
 
   Handle(AIS_InteractiveContext) m_context;
   Handle(V3d_Viewer) m_viewer;
@@ -52,8 +102,35 @@ private:
   bool m_isMouseRotating = false;
   bool m_isMousePanning = false;
   QPoint m_lastMousePos;
+  QPoint m_pressPos;
+
+  bool m_healingEnabled = false;
+  HealingReport m_lastHealingReport;
+  MemoryBudget m_memoryBudget;
+  MeshingParams m_meshingParams;
+  FaceMeshCache m_faceCache;
+  FaceMeshStats m_lastMeshStats;
+
+  struct ScenePart
+  {
+    QString filePath;
+    TopoDS_Shape shape;
+    Handle(AIS_Shape) presentation;
+    qint64 triangulationBytes = 0;
+  };
+
+  std::vector<ScenePart> m_parts;
+  QThreadPool m_loadPool;
+  QElapsedTimer m_loadTimer;
+  int m_loadGeneration = 0;
+  int m_pendingLoads = 0;
+  int m_loadedCount = 0;
+  int m_failedCount = 0;
 
   TopoDS_Shape m_shape;
   std::shared_ptr<TriMesh> m_triMesh;
   std::shared_ptr<QuadMesh> m_quadMesh;
+  // Built on the load pool, one per part; hover picks do nothing until the first one arrives.
+  std::vector<std::shared_ptr<const MeshBvh>> m_pickBvhs;
+  bool m_hoverHasHit = false;
 };
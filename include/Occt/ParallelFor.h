@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline size_t parallelWorkerCount()
+{
+  const unsigned hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 1 : static_cast<size_t>(hw);
+}
+
+// Splits [0, count) into contiguous ranges of at least minChunk items and calls fn(begin, end)
+// for each of them, one range per hardware thread. The calling thread processes the first range.
+template <typename Fn>
+void parallelFor(size_t count, size_t minChunk, Fn&& fn)
+{
+  if (count == 0)
+    return;
+
+  const size_t chunk = std::max<size_t>(minChunk, 1);
+  const size_t ranges = std::min(parallelWorkerCount(), (count + chunk - 1) / chunk);
+  if (ranges <= 1)
+  {
+    fn(size_t(0), count);
+    return;
+  }
+
+  const size_t step = (count + ranges - 1) / ranges;
+  std::vector<std::thread> workers;
+  workers.reserve(ranges - 1);
+  for (size_t begin = step; begin < count; begin += step)
+  {
+    const size_t end = std::min(count, begin + step);
+    workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+  }
+
+  fn(size_t(0), std::min(count, step));
+
+  for (auto& w : workers)
+    w.join();
+}
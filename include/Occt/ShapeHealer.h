@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <TopoDS_Shape.hxx>
+
+struct HealingReport
+{
+  int faceCount = 0;
+  int clusterCount = 0;
+  int fixedFaces = 0;
+  int freeEdges = 0;
+  int multipleEdges = 0;
+  int degeneratedShapes = 0;
+  int deletedFaces = 0;
+  // Faces ShapeFix threw on and clusters whose sewing threw; both are kept as they were read.
+  int failedFaces = 0;
+  int failedClusters = 0;
+  qint64 elapsedMs = 0;
+  bool fromCache = false;
+};
+
+class ShapeHealer
+{
+public:
+  static constexpr double kDefaultTolerance = 1e-3;
+
+  static TopoDS_Shape heal(const TopoDS_Shape& shape, double tolerance, HealingReport* report);
+
+  static bool readHealedIgsFile(const QString& filePath, double tolerance, TopoDS_Shape& shape,
+                                HealingReport* report, QString* errorText);
+};
@@ -0,0 +1,131 @@
+#include "App/CommandLine.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "App/ConversionServer.h"
+#include "Occt/MeshBuilder.h"
+#include "Occt/MeshRasterizer.h"
+
+bool CommandLine::isBatchInvocation(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    // QCommandLineParser also accepts the "--option=value" spelling.
+    if (std::strcmp(argv[i], "--thumbnail") == 0 || std::strcmp(argv[i], "--serve") == 0 ||
+        std::strncmp(argv[i], "--thumbnail=", 12) == 0 || std::strncmp(argv[i], "--serve=", 8) == 0)
+      return true;
+  }
+  return false;
+}
+
+static int runServer(QCoreApplication& app, const QString& socketName, const ConversionServerOptions& options)
+{
+  QTextStream err(stderr);
+  QTextStream out(stdout);
+
+  ConversionServer server(options);
+  QString errorText;
+  if (!server.listen(socketName, &errorText))
+  {
+    err << errorText << '\n';
+    return 1;
+  }
+
+  out << QStringLiteral("转换服务已启动：%1").arg(socketName) << '\n';
+  out.flush();
+  return app.exec();
+}
+
+int CommandLine::run(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QTextStream err(stderr);
+  QTextStream out(stdout);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral("IgsMesh 批处理模式"));
+  parser.addHelpOption();
+  const QCommandLineOption thumbnailOption(QStringLiteral("thumbnail"), QStringLiteral("输出 PNG 缩略图路径"),
+                                           QStringLiteral("png"));
+  const QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("缩略图边长（像素），默认 512"),
+                                      QStringLiteral("px"), QStringLiteral("512"));
+  const QCommandLineOption serveOption(QStringLiteral("serve"), QStringLiteral("以常驻服务方式监听本地套接字"),
+                                       QStringLiteral("socket"));
+  const QCommandLineOption jobsOption(QStringLiteral("jobs"), QStringLiteral("服务模式下的并发任务数，默认等于 CPU 线程数"),
+                                      QStringLiteral("n"), QStringLiteral("0"));
+  const QCommandLineOption queueOption(QStringLiteral("queue"), QStringLiteral("服务模式下允许排队的任务数，默认 64"),
+                                       QStringLiteral("n"), QStringLiteral("64"));
+  const QCommandLineOption cacheOption(QStringLiteral("cache-mb"), QStringLiteral("服务模式下的网格缓存上限（MB），默认 1024"),
+                                       QStringLiteral("mb"), QStringLiteral("1024"));
+  parser.addOption(thumbnailOption);
+  parser.addOption(sizeOption);
+  parser.addOption(serveOption);
+  parser.addOption(jobsOption);
+  parser.addOption(queueOption);
+  parser.addOption(cacheOption);
+  parser.addPositionalArgument(QStringLiteral("input"), QStringLiteral("输入 IGS/IGES 文件"));
+  parser.process(app);
+
+  if (parser.isSet(serveOption))
+  {
+    ConversionServerOptions options;
+    options.maxConcurrentJobs = parser.value(jobsOption).toInt();
+    options.maxQueuedJobs = std::max(0, parser.value(queueOption).toInt());
+    options.meshCacheBytes = std::max(0LL, parser.value(cacheOption).toLongLong()) * 1024 * 1024;
+    return runServer(app, parser.value(serveOption), options);
+  }
+
+  const QStringList inputs = parser.positionalArguments();
+  if (inputs.size() != 1)
+  {
+    err << QStringLiteral("需要且仅需要一个输入文件") << '\n';
+    return 2;
+  }
+
+  bool sizeOk = false;
+  const int size = parser.value(sizeOption).toInt(&sizeOk);
+  if (!sizeOk || size <= 0 || size > MeshRasterizer::kMaxImageSize)
+  {
+    err << QStringLiteral("无效的尺寸：%1（应为 1 到 %2）").arg(parser.value(sizeOption)).arg(MeshRasterizer::kMaxImageSize)
+        << '\n';
+    return 2;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QString errorText;
+  TopoDS_Shape shape;
+  if (!MeshBuilder::readIgsFile(inputs.front(), shape, &errorText))
+  {
+    err << errorText << '\n';
+    return 1;
+  }
+
+  const std::shared_ptr<TriMesh> mesh = MeshBuilder::buildTriMesh(shape);
+  if (mesh->vertices.empty() || mesh->indices.empty())
+  {
+    err << QStringLiteral("模型网格为空（可能是导入失败或无法三角化）") << '\n';
+    return 1;
+  }
+  const qint64 meshMs = timer.restart();
+
+  if (!MeshRasterizer::renderToPng(parser.value(thumbnailOption), *mesh, size, size, &errorText))
+  {
+    err << errorText << '\n';
+    return 1;
+  }
+
+  out << QStringLiteral("%1 个三角形，网格 %2 ms，渲染 %3 ms")
+           .arg(mesh->indices.size() / 3)
+           .arg(meshMs)
+           .arg(timer.elapsed())
+      << '\n';
+  return 0;
+}
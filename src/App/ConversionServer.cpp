@@ -0,0 +1,303 @@
+#include "App/ConversionServer.h"
+
+#include <exception>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QThread>
+
+#include <Standard_Failure.hxx>
+
+#include "Occt/FunctionJob.h"
+#include "Occt/MemoryBudget.h"
+#include "Occt/MeshBuilder.h"
+#include "Occt/MeshCodec.h"
+#include "Occt/MeshRasterizer.h"
+#include "Occt/ObjExporter.h"
+#include "Occt/ShapeHealer.h"
+
+namespace
+{
+QJsonObject errorReply(const QString& message)
+{
+  QJsonObject reply;
+  reply.insert(QStringLiteral("ok"), false);
+  reply.insert(QStringLiteral("error"), message);
+  return reply;
+}
+
+QString meshCacheKey(const QFileInfo& info, const MeshingParams& params, bool heal)
+{
+  return QStringLiteral("%1|%2|%3|%4|%5|%6|%7")
+    .arg(info.canonicalFilePath())
+    .arg(heal ? 1 : 0)
+    .arg(info.size())
+    .arg(info.lastModified().toMSecsSinceEpoch())
+    .arg(params.linearDeflection, 0, 'g', 17)
+    .arg(params.angularDeflection, 0, 'g', 17)
+    .arg(params.weldTolerance, 0, 'g', 17);
+}
+
+QJsonObject runConversion(ConversionServer& server, const QJsonObject& request)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  const QString inputPath = request.value(QStringLiteral("input")).toString();
+  const QString outputPath = request.value(QStringLiteral("output")).toString();
+  const QString format = request.value(QStringLiteral("format")).toString(QStringLiteral("obj"));
+
+  MeshingParams params;
+  params.linearDeflection = request.value(QStringLiteral("linearDeflection")).toDouble(params.linearDeflection);
+  params.angularDeflection = request.value(QStringLiteral("angularDeflection")).toDouble(params.angularDeflection);
+  params.weldTolerance = request.value(QStringLiteral("weldTolerance")).toDouble(params.weldTolerance);
+  const int imageSize = request.value(QStringLiteral("size")).toInt(512);
+  const bool heal = request.value(QStringLiteral("heal")).toBool(false);
+  const int positionBits = request.value(QStringLiteral("positionBits")).toInt(MeshCodec::kDefaultPositionBits);
+
+  if (format != QStringLiteral("obj") && format != QStringLiteral("obj-quad") && format != QStringLiteral("png")
+      && format != QStringLiteral("imz"))
+    return errorReply(QStringLiteral("不支持的输出格式：%1").arg(format));
+  if (outputPath.isEmpty())
+    return errorReply(QStringLiteral("缺少输出路径"));
+  if (format == QStringLiteral("png") && (imageSize <= 0 || imageSize > MeshRasterizer::kMaxImageSize))
+    return errorReply(
+      QStringLiteral("无效的图像尺寸：%1（应为 1 到 %2）").arg(imageSize).arg(MeshRasterizer::kMaxImageSize));
+  if (format == QStringLiteral("imz")
+      && (positionBits < MeshCodec::kMinPositionBits || positionBits > MeshCodec::kMaxPositionBits))
+    return errorReply(QStringLiteral("无效的量化位数：%1（应为 %2 到 %3）")
+                        .arg(positionBits)
+                        .arg(MeshCodec::kMinPositionBits)
+                        .arg(MeshCodec::kMaxPositionBits));
+  if (params.linearDeflection <= 0.0 || params.angularDeflection <= 0.0 || params.weldTolerance <= 0.0)
+    return errorReply(QStringLiteral("网格参数必须为正数"));
+
+  const QFileInfo inputInfo(inputPath);
+  if (inputPath.isEmpty() || !inputInfo.isFile())
+    return errorReply(QStringLiteral("输入文件不存在：%1").arg(inputPath));
+
+  const QString key = meshCacheKey(inputInfo, params, heal);
+  std::shared_ptr<const TriMesh> mesh = server.cachedMesh(key);
+  const bool cached = static_cast<bool>(mesh);
+  if (!mesh)
+  {
+    QString errorText;
+    TopoDS_Shape shape;
+    const bool loaded = heal ? ShapeHealer::readHealedIgsFile(inputPath, ShapeHealer::kDefaultTolerance, shape,
+                                                              nullptr, &errorText)
+                             : MeshBuilder::readIgsFile(inputPath, shape, &errorText);
+    if (!loaded)
+      return errorReply(errorText);
+
+    std::shared_ptr<TriMesh> built = MeshBuilder::buildTriMesh(shape, params);
+    if (built->vertices.empty() || built->indices.empty())
+      return errorReply(QStringLiteral("模型网格为空（可能是导入失败或无法三角化）"));
+    mesh = built;
+    server.storeMesh(key, mesh);
+  }
+
+  QString errorText;
+  bool written = false;
+  if (format == QStringLiteral("png"))
+    written = MeshRasterizer::renderToPng(outputPath, *mesh, imageSize, imageSize, &errorText);
+  else if (format == QStringLiteral("imz"))
+    written = MeshCodec::writeFile(outputPath, *mesh, positionBits, &errorText);
+  else if (format == QStringLiteral("obj-quad"))
+    written = ObjExporter::exportQuadMesh(outputPath, *MeshBuilder::buildQuadMesh(*mesh), &errorText);
+  else
+    written = ObjExporter::exportTriMesh(outputPath, *mesh, &errorText);
+  if (!written)
+    return errorReply(errorText);
+
+  QJsonObject reply;
+  reply.insert(QStringLiteral("ok"), true);
+  reply.insert(QStringLiteral("vertices"), static_cast<qint64>(mesh->vertices.size()));
+  reply.insert(QStringLiteral("triangles"), static_cast<qint64>(mesh->indices.size() / 3));
+  reply.insert(QStringLiteral("cached"), cached);
+  reply.insert(QStringLiteral("elapsedMs"), timer.elapsed());
+  return reply;
+}
+} // namespace
+
+ConversionServer::ConversionServer(const ConversionServerOptions& options, QObject* parent)
+  : QObject(parent)
+  , m_options(options)
+{
+  if (m_options.maxConcurrentJobs <= 0)
+    m_options.maxConcurrentJobs = QThread::idealThreadCount();
+  m_pool.setMaxThreadCount(m_options.maxConcurrentJobs);
+}
+
+ConversionServer::~ConversionServer()
+{
+  m_pool.waitForDone();
+}
+
+bool ConversionServer::listen(const QString& socketName, QString* errorText)
+{
+  MeshBuilder::warmUp();
+
+  m_server = new QLocalServer(this);
+  m_server->setSocketOptions(QLocalServer::UserAccessOption);
+
+  // A socket file left by a crashed server blocks listen(); only remove it when nobody answers on it.
+  QLocalSocket probe;
+  probe.connectToServer(socketName);
+  if (probe.waitForConnected(500))
+  {
+    probe.abort();
+    if (errorText)
+      *errorText = QStringLiteral("本地套接字 %1 已有服务实例在运行").arg(socketName);
+    return false;
+  }
+  QLocalServer::removeServer(socketName);
+  if (!m_server->listen(socketName))
+  {
+    if (errorText)
+      *errorText = QStringLiteral("无法监听本地套接字 %1：%2").arg(socketName, m_server->errorString());
+    return false;
+  }
+
+  connect(m_server, &QLocalServer::newConnection, this, &ConversionServer::acceptConnections);
+  return true;
+}
+
+void ConversionServer::acceptConnections()
+{
+  while (QLocalSocket* socket = m_server->nextPendingConnection())
+  {
+    m_pendingInput.insert(socket, QByteArray());
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+    connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+      m_pendingInput.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void ConversionServer::readRequests(QLocalSocket* socket)
+{
+  QByteArray& buffer = m_pendingInput[socket];
+  buffer.append(socket->readAll());
+
+  int newline = buffer.indexOf('\n');
+  while (newline >= 0)
+  {
+    const QByteArray line = buffer.left(newline).trimmed();
+    buffer.remove(0, newline + 1);
+    newline = buffer.indexOf('\n');
+    if (line.isEmpty())
+      continue;
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    if (!doc.isObject())
+    {
+      writeReply(socket, errorReply(QStringLiteral("无效的 JSON 请求：%1").arg(parseError.errorString())));
+      continue;
+    }
+    submitJob(socket, doc.object());
+  }
+
+  // What is left is an unfinished line; a client that never sends a newline would grow it without bound.
+  if (buffer.size() > m_options.maxRequestBytes)
+  {
+    m_pendingInput.remove(socket);
+    writeReply(socket, errorReply(QStringLiteral("请求过长，连接已断开")));
+    socket->disconnectFromServer();
+  }
+}
+
+void ConversionServer::submitJob(QLocalSocket* socket, const QJsonObject& request)
+{
+  const QJsonValue id = request.value(QStringLiteral("id"));
+  if (m_jobsInFlight >= m_options.maxConcurrentJobs + m_options.maxQueuedJobs)
+  {
+    QJsonObject reply = errorReply(QStringLiteral("服务繁忙，请稍后重试"));
+    reply.insert(QStringLiteral("id"), id);
+    reply.insert(QStringLiteral("busy"), true);
+    writeReply(socket, reply);
+    return;
+  }
+
+  ++m_jobsInFlight;
+  QPointer<QLocalSocket> target(socket);
+  m_pool.start(new FunctionJob([this, target, request, id]() {
+    QJsonObject reply;
+    try
+    {
+      reply = runConversion(*this, request);
+    }
+    catch (const Standard_Failure& failure)
+    {
+      reply = errorReply(QStringLiteral("转换失败：%1").arg(QString::fromUtf8(failure.GetMessageString())));
+    }
+    catch (const std::exception& e)
+    {
+      reply = errorReply(QStringLiteral("转换失败：%1").arg(QString::fromLocal8Bit(e.what())));
+    }
+    reply.insert(QStringLiteral("id"), id);
+    QMetaObject::invokeMethod(
+      this, [this, target, reply]() { finishJob(target.data(), reply); }, Qt::QueuedConnection);
+  }));
+}
+
+void ConversionServer::finishJob(QLocalSocket* socket, const QJsonObject& reply)
+{
+  --m_jobsInFlight;
+  if (socket && socket->state() == QLocalSocket::ConnectedState)
+    writeReply(socket, reply);
+}
+
+void ConversionServer::writeReply(QLocalSocket* socket, const QJsonObject& reply)
+{
+  socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+  socket->write("\n");
+  socket->flush();
+}
+
+std::shared_ptr<const TriMesh> ConversionServer::cachedMesh(const QString& key)
+{
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  for (auto it = m_cacheLru.begin(); it != m_cacheLru.end(); ++it)
+  {
+    if (it->key == key)
+    {
+      m_cacheLru.splice(m_cacheLru.begin(), m_cacheLru, it);
+      return m_cacheLru.front().mesh;
+    }
+  }
+  return nullptr;
+}
+
+void ConversionServer::storeMesh(const QString& key, const std::shared_ptr<const TriMesh>& mesh)
+{
+  const qint64 bytes = MemoryBudget::bytesOf(*mesh);
+  if (bytes > m_options.meshCacheBytes)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  for (auto it = m_cacheLru.begin(); it != m_cacheLru.end(); ++it)
+  {
+    if (it->key == key)
+    {
+      m_cacheBytes -= it->bytes;
+      m_cacheLru.erase(it);
+      break;
+    }
+  }
+
+  m_cacheLru.push_front(CacheEntry{key, mesh, bytes});
+  m_cacheBytes += bytes;
+  while (m_cacheBytes > m_options.meshCacheBytes && !m_cacheLru.empty())
+  {
+    m_cacheBytes -= m_cacheLru.back().bytes;
+    m_cacheLru.pop_back();
+  }
+}
@@ -2,12 +2,15 @@
 
 #include <QAction>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QLabel>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QToolBar>
 
+#include "Occt/MeshCodec.h"
 #include "Occt/OcctViewerWidget.h"
 
 MainWindow::MainWindow(QWidget* parent)
@@ -27,38 +30,141 @@ void MainWindow::createUi()
   auto* fileMenu = menuBar()->addMenu(QStringLiteral("文件"));
 
   m_importIgsAction = fileMenu->addAction(QStringLiteral("导入 IGS..."));
+  m_importMeshAction = fileMenu->addAction(QStringLiteral("导入网格..."));
   m_exportObjAction = fileMenu->addAction(QStringLiteral("导出 OBJ..."));
+  m_exportCompressedAction = fileMenu->addAction(QStringLiteral("导出压缩网格..."));
+  fileMenu->addSeparator();
+  m_healAction = fileMenu->addAction(QStringLiteral("导入时修复与缝合"));
+  m_healAction->setCheckable(true);
+  m_memoryBudgetAction = fileMenu->addAction(QStringLiteral("内存预算..."));
+  m_meshingAction = fileMenu->addAction(QStringLiteral("网格参数..."));
+  m_exportQuadsAction = fileMenu->addAction(QStringLiteral("导出 OBJ 时合并四边形"));
+  m_exportQuadsAction->setCheckable(true);
   fileMenu->addSeparator();
   m_exitAction = fileMenu->addAction(QStringLiteral("退出"));
 
   auto* toolBar = addToolBar(QStringLiteral("工具"));
   toolBar->setMovable(false);
   toolBar->addAction(m_importIgsAction);
+  toolBar->addAction(m_importMeshAction);
   toolBar->addAction(m_exportObjAction);
 
+  m_hoverLabel = new QLabel(this);
+  statusBar()->addPermanentWidget(m_hoverLabel);
   statusBar()->showMessage(QStringLiteral("就绪"));
 }
 
 void MainWindow::connectSignals()
 {
   connect(m_importIgsAction, &QAction::triggered, this, &MainWindow::importIgs);
+  connect(m_importMeshAction, &QAction::triggered, this, &MainWindow::importMesh);
   connect(m_exportObjAction, &QAction::triggered, this, &MainWindow::exportObj);
+  connect(m_exportCompressedAction, &QAction::triggered, this, &MainWindow::exportCompressed);
+  connect(m_healAction, &QAction::toggled, m_viewer, &OcctViewerWidget::setHealingEnabled);
+  connect(m_memoryBudgetAction, &QAction::triggered, this, &MainWindow::configureMemoryBudget);
+  connect(m_meshingAction, &QAction::triggered, this, &MainWindow::configureMeshing);
   connect(m_exitAction, &QAction::triggered, this, &QWidget::close);
+  connect(m_viewer, &OcctViewerWidget::partLoaded, this, &MainWindow::onPartLoaded);
+  connect(m_viewer, &OcctViewerWidget::sceneLoadFinished, this, &MainWindow::onSceneLoadFinished);
+  connect(m_viewer, &OcctViewerWidget::selectionChanged, this, [this](const QString& filePath) {
+    if (filePath.isEmpty())
+      statusBar()->showMessage(QStringLiteral("未选中零件，导出整个场景"), 3000);
+    else
+      statusBar()->showMessage(QStringLiteral("已选中：%1（导出仅包含该零件）").arg(filePath), 5000);
+  });
+  connect(m_viewer, &OcctViewerWidget::hoverPointChanged, this, [this](bool hasHit, double x, double y, double z) {
+    // A separate label, so moving off the model does not wipe load and export messages.
+    if (!hasHit)
+    {
+      m_hoverLabel->clear();
+      return;
+    }
+    m_hoverLabel->setText(QStringLiteral("X: %1  Y: %2  Z: %3")
+                            .arg(x, 0, 'f', 3)
+                            .arg(y, 0, 'f', 3)
+                            .arg(z, 0, 'f', 3));
+  });
 }
 
 void MainWindow::importIgs()
 {
-  const QString filePath = QFileDialog::getOpenFileName(
+  const QStringList filePaths = QFileDialog::getOpenFileNames(
     this,
     QStringLiteral("选择 IGS 文件"),
     QString(),
     QStringLiteral("IGS/IGES (*.igs *.iges);;所有文件 (*.*)"));
 
+  if (filePaths.isEmpty())
+    return;
+
+  m_loadErrors.clear();
+  statusBar()->showMessage(QStringLiteral("正在导入 %1 个文件...").arg(filePaths.size()));
+  m_viewer->loadIgsFiles(filePaths);
+}
+
+void MainWindow::onPartLoaded(const QString& filePath, bool ok, const QString& errorText)
+{
+  if (!ok)
+  {
+    m_loadErrors << QStringLiteral("%1：%2").arg(filePath, errorText);
+    return;
+  }
+
+  if (!m_viewer->healingEnabled())
+  {
+    statusBar()->showMessage(QStringLiteral("已导入：%1").arg(filePath), 3000);
+    return;
+  }
+
+  const HealingReport& report = m_viewer->lastHealingReport();
+  if (report.fromCache)
+  {
+    statusBar()->showMessage(QStringLiteral("已导入：%1（使用已缓存的修复结果，%2 ms）").arg(filePath).arg(report.elapsedMs), 5000);
+    return;
+  }
+  statusBar()->showMessage(QStringLiteral("已导入：%1（修复 %2 ms：%3 个面分为 %4 组，修复 %5 个面，"
+                                          "剩余自由边 %6，多重边 %7，退化 %8，删除面 %9）")
+                             .arg(filePath)
+                             .arg(report.elapsedMs)
+                             .arg(report.faceCount)
+                             .arg(report.clusterCount)
+                             .arg(report.fixedFaces)
+                             .arg(report.freeEdges)
+                             .arg(report.multipleEdges)
+                             .arg(report.degeneratedShapes)
+                             .arg(report.deletedFaces)
+                             + (report.failedFaces > 0 || report.failedClusters > 0
+                                  ? QStringLiteral("；%1 个面、%2 组修复失败，已保留原始面")
+                                      .arg(report.failedFaces)
+                                      .arg(report.failedClusters)
+                                  : QString()),
+                           8000);
+}
+
+void MainWindow::onSceneLoadFinished(int loadedCount, int failedCount, qint64 elapsedMs)
+{
+  if (loadedCount + failedCount > 1)
+  {
+    statusBar()->showMessage(
+      QStringLiteral("已导入 %1 个文件，失败 %2 个，用时 %3 ms").arg(loadedCount).arg(failedCount).arg(elapsedMs), 5000);
+  }
+  if (!m_loadErrors.isEmpty())
+    QMessageBox::critical(this, QStringLiteral("导入失败"), m_loadErrors.join(QLatin1Char('\n')));
+}
+
+void MainWindow::importMesh()
+{
+  const QString filePath = QFileDialog::getOpenFileName(
+    this,
+    QStringLiteral("选择网格文件"),
+    QString(),
+    QStringLiteral("网格 (*.obj *.stl *.ply *.imz);;所有文件 (*.*)"));
+
   if (filePath.isEmpty())
     return;
 
   QString errorText;
-  if (!m_viewer->loadIgsFile(filePath, &errorText))
+  if (!m_viewer->loadMeshFile(filePath, &errorText))
   {
     QMessageBox::critical(this, QStringLiteral("导入失败"), errorText);
     return;
@@ -69,6 +175,13 @@ void MainWindow::importIgs()
 
 void MainWindow::exportObj()
 {
+  // The scene is still being assembled; an export now would miss the parts that have not arrived.
+  if (m_viewer->isLoading())
+  {
+    statusBar()->showMessage(QStringLiteral("正在导入，请等待导入完成后再导出"), 3000);
+    return;
+  }
+
   const QString filePath = QFileDialog::getSaveFileName(
     this,
     QStringLiteral("导出 OBJ"),
@@ -79,11 +192,108 @@ void MainWindow::exportObj()
     return;
 
   QString errorText;
-  if (!m_viewer->exportObjFile(filePath, false, &errorText))
+  if (!m_viewer->exportObjFile(filePath, m_exportQuadsAction->isChecked(), &errorText))
   {
     QMessageBox::critical(this, QStringLiteral("导出失败"), errorText);
     return;
   }
 
-  statusBar()->showMessage(QStringLiteral("已导出：%1").arg(filePath), 3000);
+  showExportResult(filePath);
+}
+
+void MainWindow::exportCompressed()
+{
+  // The scene is still being assembled; an export now would miss the parts that have not arrived.
+  if (m_viewer->isLoading())
+  {
+    statusBar()->showMessage(QStringLiteral("正在导入，请等待导入完成后再导出"), 3000);
+    return;
+  }
+
+  const QString filePath = QFileDialog::getSaveFileName(
+    this,
+    QStringLiteral("导出压缩网格"),
+    QString(),
+    QStringLiteral("压缩网格 (*.imz)"));
+
+  if (filePath.isEmpty())
+    return;
+
+  bool ok = false;
+  const int positionBits = QInputDialog::getInt(
+    this,
+    QStringLiteral("导出压缩网格"),
+    QStringLiteral("坐标量化位数（相对包围盒）："),
+    MeshCodec::kDefaultPositionBits,
+    MeshCodec::kMinPositionBits,
+    MeshCodec::kMaxPositionBits,
+    1,
+    &ok);
+  if (!ok)
+    return;
+
+  QString errorText;
+  if (!m_viewer->exportCompressedFile(filePath, positionBits, &errorText))
+  {
+    QMessageBox::critical(this, QStringLiteral("导出失败"), errorText);
+    return;
+  }
+
+  showExportResult(filePath);
+}
+
+void MainWindow::showExportResult(const QString& filePath)
+{
+  QString message = QStringLiteral("已导出：%1").arg(filePath);
+  const FaceMeshStats& stats = m_viewer->lastMeshStats();
+  if (stats.faceCount > 0)
+  {
+    message += QStringLiteral("（%1 个面：重新三角化 %2，重新焊接 %3，重新配对 %4，用时 %5 ms）")
+                 .arg(stats.faceCount)
+                 .arg(stats.triangulatedFaces)
+                 .arg(stats.weldedFaces)
+                 .arg(stats.pairedFaces)
+                 .arg(stats.elapsedMs);
+  }
+  message += QStringLiteral("；") + m_viewer->memoryBudget().summary();
+  statusBar()->showMessage(message, 8000);
+}
+
+void MainWindow::configureMeshing()
+{
+  MeshingParams params = m_viewer->meshingParams();
+  bool ok = false;
+  params.linearDeflection = QInputDialog::getDouble(
+    this, QStringLiteral("网格参数"), QStringLiteral("线性偏差："), params.linearDeflection, 1e-4, 1e4, 4, &ok);
+  if (!ok)
+    return;
+  params.angularDeflection = QInputDialog::getDouble(
+    this, QStringLiteral("网格参数"), QStringLiteral("角度偏差（弧度）："), params.angularDeflection, 0.01, 3.14, 3, &ok);
+  if (!ok)
+    return;
+  params.weldTolerance = QInputDialog::getDouble(
+    this, QStringLiteral("网格参数"), QStringLiteral("顶点焊接容差："), params.weldTolerance, 1e-9, 1.0, 9, &ok);
+  if (!ok)
+    return;
+
+  m_viewer->setMeshingParams(params);
+}
+
+void MainWindow::configureMemoryBudget()
+{
+  bool ok = false;
+  const int limitMb = QInputDialog::getInt(
+    this,
+    QStringLiteral("内存预算"),
+    QStringLiteral("网格处理内存上限（MB，0 表示不限制）："),
+    static_cast<int>(m_viewer->memoryBudget().limitBytes() / (1024 * 1024)),
+    0,
+    1024 * 1024,
+    256,
+    &ok);
+  if (!ok)
+    return;
+
+  m_viewer->setMemoryBudget(static_cast<qint64>(limitMb) * 1024 * 1024);
+  statusBar()->showMessage(m_viewer->memoryBudget().summary(), 5000);
 }
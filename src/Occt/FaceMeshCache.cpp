@@ -0,0 +1,469 @@
+#include "Occt/FaceMeshCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory_resource>
+
+#include <QElapsedTimer>
+
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+#include "Occt/MemoryBudget.h"
+#include "Occt/MeshBuilder.h"
+#include "Occt/ParallelFor.h"
+
+namespace
+{
+// Older variants of a face are dropped once it has been meshed with this many parameter sets.
+constexpr size_t kMaxVariantsPerFace = 4;
+
+template <typename Fn>
+void forEachDynamic(size_t count, Fn&& fn)
+{
+  std::atomic<size_t> next{0};
+  parallelFor(std::min(parallelWorkerCount(), count), 1, [&](size_t, size_t) {
+    for (size_t i = next++; i < count; i = next++)
+      fn(i);
+  });
+}
+
+std::shared_ptr<const FaceMeshCache::WeldedFace> weldFace(const Handle(Poly_Triangulation)& tri,
+                                                         const TopLoc_Location& location, double weldTolerance)
+{
+  auto welded = std::make_shared<FaceMeshCache::WeldedFace>();
+  const gp_Trsf trsf = location.Transformation();
+  const double scale = 1.0 / weldTolerance;
+
+  std::unordered_map<FaceMeshCache::WeldKey, int, FaceMeshCache::WeldKeyHash> localIds;
+  localIds.reserve(static_cast<size_t>(tri->NbNodes()));
+  std::vector<int> nodeToLocal(static_cast<size_t>(tri->NbNodes()) + 1, -1);
+
+  auto localIdOf = [&](int node) -> int {
+    int& id = nodeToLocal[static_cast<size_t>(node)];
+    if (id >= 0)
+      return id;
+
+    gp_Pnt p = tri->Node(node);
+    p.Transform(trsf);
+    const FaceMeshCache::WeldKey key{
+      static_cast<long long>(std::llround(p.X() * scale)),
+      static_cast<long long>(std::llround(p.Y() * scale)),
+      static_cast<long long>(std::llround(p.Z() * scale)),
+    };
+    const auto inserted = localIds.emplace(key, static_cast<int>(welded->vertices.size()));
+    if (inserted.second)
+    {
+      welded->vertices.push_back(p);
+      welded->keys.push_back(key);
+    }
+    id = inserted.first->second;
+    return id;
+  };
+
+  const int nbTriangles = tri->NbTriangles();
+  welded->triangles.reserve(static_cast<size_t>(nbTriangles) * 3);
+  for (int i = 1; i <= nbTriangles; ++i)
+  {
+    int n1 = 0, n2 = 0, n3 = 0;
+    tri->Triangle(i).Get(n1, n2, n3);
+    welded->triangles.push_back(localIdOf(n1));
+    welded->triangles.push_back(localIdOf(n2));
+    welded->triangles.push_back(localIdOf(n3));
+  }
+  return welded;
+}
+
+std::shared_ptr<const std::vector<FaceMeshCache::QuadCandidate>> pairFace(const FaceMeshCache::WeldedFace& welded)
+{
+  struct TriRef
+  {
+    int triIndex = 0;
+    int localEdge = 0;
+  };
+
+  const std::vector<int>& tris = welded.triangles;
+  const int triCount = static_cast<int>(tris.size() / 3);
+  std::unordered_map<uint64_t, TriRef> edgeOwner;
+  edgeOwner.reserve(static_cast<size_t>(triCount) * 2);
+
+  auto candidates = std::make_shared<std::vector<FaceMeshCache::QuadCandidate>>();
+  auto triVertex = [&](int t, int i) -> int { return tris[static_cast<size_t>(t) * 3 + i]; };
+  auto thirdVertex = [&](int t, int a, int b) -> int {
+    for (int i = 0; i < 3; ++i)
+    {
+      const int v = triVertex(t, i);
+      if (v != a && v != b)
+        return v;
+    }
+    return triVertex(t, 2);
+  };
+
+  for (int t = 0; t < triCount; ++t)
+  {
+    for (int e = 0; e < 3; ++e)
+    {
+      const int u = triVertex(t, e);
+      const int v = triVertex(t, (e + 1) % 3);
+      const uint64_t key = (static_cast<uint64_t>(std::min(u, v)) << 32) | static_cast<uint32_t>(std::max(u, v));
+      const auto inserted = edgeOwner.emplace(key, TriRef{t, e});
+      if (inserted.second)
+        continue;
+
+      const TriRef owner = inserted.first->second;
+      if (owner.triIndex == t)
+        continue;
+
+      FaceMeshCache::QuadCandidate c;
+      c.t0 = owner.triIndex;
+      c.t1 = t;
+      c.sharedA = triVertex(owner.triIndex, owner.localEdge);
+      c.sharedB = triVertex(owner.triIndex, (owner.localEdge + 1) % 3);
+      c.other0 = thirdVertex(c.t0, c.sharedA, c.sharedB);
+      c.other1 = thirdVertex(c.t1, c.sharedA, c.sharedB);
+      if (MeshBuilder::canMergeTriangles(welded.vertices[c.sharedA], welded.vertices[c.sharedB],
+                                         welded.vertices[c.other0], welded.vertices[c.other1]))
+        candidates->push_back(c);
+    }
+  }
+  return candidates;
+}
+} // namespace
+
+FaceMeshCache::FaceRecord& FaceMeshCache::recordFor(const TopoDS_Face& face)
+{
+  FaceRecord& record = m_faces[face.TShape().get()];
+  if (record.tshape.IsNull())
+  {
+    record.tshape = face.TShape();
+    record.face = face;
+  }
+  return record;
+}
+
+const FaceMeshCache::TriangulationVariant* FaceMeshCache::findTriangulation(const FaceRecord& record,
+                                                                            const MeshingParams& params)
+{
+  for (const TriangulationVariant& v : record.triangulations)
+  {
+    if (MeshingParams::sameValue(v.linearDeflection, params.linearDeflection)
+        && MeshingParams::sameValue(v.angularDeflection, params.angularDeflection))
+      return &v;
+  }
+  return nullptr;
+}
+
+FaceMeshCache::InstanceWeld* FaceMeshCache::findWeld(FaceRecord& record, const TopLoc_Location& location,
+                                                     const MeshingParams& params)
+{
+  for (WeldVariant& v : record.welds)
+  {
+    if (!(v.params == params))
+      continue;
+    for (InstanceWeld& instance : v.instances)
+    {
+      if (instance.location.IsEqual(location))
+        return &instance;
+    }
+    return nullptr;
+  }
+  return nullptr;
+}
+
+void FaceMeshCache::storeWeld(FaceRecord& record, const TopLoc_Location& location, const MeshingParams& params,
+                              const std::shared_ptr<const WeldedFace>& welded)
+{
+  for (WeldVariant& v : record.welds)
+  {
+    if (v.params == params)
+    {
+      v.instances.push_back(InstanceWeld{location, welded, nullptr});
+      return;
+    }
+  }
+  if (record.welds.size() >= kMaxVariantsPerFace)
+    record.welds.erase(record.welds.begin());
+  record.welds.push_back(WeldVariant{params, {InstanceWeld{location, welded, nullptr}}});
+}
+
+void FaceMeshCache::adoptTriangulations(const TopoDS_Shape& shape, const MeshingParams& params)
+{
+  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+  {
+    const TopoDS_Face face = TopoDS::Face(exp.Current());
+    TopLoc_Location loc;
+    const Handle(Poly_Triangulation) tri = BRep_Tool::Triangulation(face, loc);
+    if (tri.IsNull())
+      continue;
+
+    FaceRecord& record = recordFor(face);
+    if (findTriangulation(record, params))
+      continue;
+    if (record.triangulations.size() >= kMaxVariantsPerFace)
+      record.triangulations.erase(record.triangulations.begin());
+    record.triangulations.push_back(TriangulationVariant{params.linearDeflection, params.angularDeflection, tri});
+  }
+}
+
+std::vector<FaceMeshCache::FaceUse> FaceMeshCache::prepareFaces(const TopoDS_Shape& shape, const MeshingParams& params,
+                                                                bool withCandidates, FaceMeshStats& stats)
+{
+  std::vector<FaceUse> uses;
+  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+  {
+    const TopoDS_Face face = TopoDS::Face(exp.Current());
+    FaceUse use;
+    use.record = &recordFor(face);
+    use.location = face.Location();
+    use.orientation = face.Orientation();
+    uses.push_back(use);
+  }
+  stats.faceCount = static_cast<int>(uses.size());
+
+  // Stage 1: re-mesh only faces that need a weld and have no triangulation for these deflections.
+  std::vector<size_t> weldMissing;
+  std::vector<FaceRecord*> triangulationMissing;
+  for (size_t i = 0; i < uses.size(); ++i)
+  {
+    FaceUse& use = uses[i];
+    if (const InstanceWeld* weld = findWeld(*use.record, use.location, params))
+    {
+      use.welded = weld->welded;
+      use.candidates = weld->candidates;
+      continue;
+    }
+    weldMissing.push_back(i);
+    if (!findTriangulation(*use.record, params))
+      triangulationMissing.push_back(use.record);
+  }
+  std::sort(triangulationMissing.begin(), triangulationMissing.end());
+  triangulationMissing.erase(std::unique(triangulationMissing.begin(), triangulationMissing.end()),
+                             triangulationMissing.end());
+
+  if (!triangulationMissing.empty())
+  {
+    // The recorded faces are the displayed ones, so mesh a copy and leave their triangulations alone.
+    // Copying the stale faces together keeps their shared edges shared, so they are discretized the same way.
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    for (FaceRecord* record : triangulationMissing)
+      builder.Add(compound, record->face);
+    BRepBuilderAPI_Copy copier(compound, Standard_False, Standard_False);
+    BRepMesh_IncrementalMesh mesher(copier.Shape(), params.linearDeflection, false, params.angularDeflection, true);
+    mesher.Perform();
+
+    for (FaceRecord* record : triangulationMissing)
+    {
+      TopLoc_Location loc;
+      const Handle(Poly_Triangulation) tri =
+        BRep_Tool::Triangulation(TopoDS::Face(copier.ModifiedShape(record->face)), loc);
+      if (record->triangulations.size() >= kMaxVariantsPerFace)
+        record->triangulations.erase(record->triangulations.begin());
+      record->triangulations.push_back(TriangulationVariant{params.linearDeflection, params.angularDeflection, tri});
+    }
+    stats.triangulatedFaces = static_cast<int>(triangulationMissing.size());
+  }
+
+  // Stage 2: face-local welds, independent per face.
+  if (!weldMissing.empty())
+  {
+    forEachDynamic(weldMissing.size(), [&](size_t k) {
+      FaceUse& use = uses[weldMissing[k]];
+      const TriangulationVariant* variant = findTriangulation(*use.record, params);
+      if (variant && !variant->triangulation.IsNull())
+        use.welded = weldFace(variant->triangulation, use.location, params.weldTolerance);
+      else
+        use.welded = std::make_shared<WeldedFace>();
+    });
+
+    for (const size_t i : weldMissing)
+    {
+      FaceUse& use = uses[i];
+      if (!findWeld(*use.record, use.location, params))
+        storeWeld(*use.record, use.location, params, use.welded);
+    }
+    stats.weldedFaces = static_cast<int>(weldMissing.size());
+  }
+
+  // Stage 3: quad candidates, only when a quad mesh is requested.
+  if (withCandidates)
+  {
+    std::vector<size_t> pairMissing;
+    for (size_t i = 0; i < uses.size(); ++i)
+    {
+      if (!uses[i].candidates)
+        pairMissing.push_back(i);
+    }
+
+    forEachDynamic(pairMissing.size(), [&](size_t k) {
+      FaceUse& use = uses[pairMissing[k]];
+      use.candidates = pairFace(*use.welded);
+    });
+
+    for (const size_t i : pairMissing)
+    {
+      FaceUse& use = uses[i];
+      if (InstanceWeld* weld = findWeld(*use.record, use.location, params))
+        weld->candidates = use.candidates;
+    }
+    stats.pairedFaces = static_cast<int>(pairMissing.size());
+  }
+
+  return uses;
+}
+
+void FaceMeshCache::mergeFaces(const std::vector<FaceUse>& uses, std::vector<gp_Pnt>& vertices,
+                               std::vector<std::vector<int>>& remaps)
+{
+  size_t localVertices = 0;
+  for (const FaceUse& use : uses)
+    localVertices += use.welded->vertices.size();
+  vertices.reserve(localVertices);
+  remaps.resize(uses.size());
+
+  CountingResource arenaUpstream;
+  std::pmr::monotonic_buffer_resource arena(&arenaUpstream);
+  std::pmr::unordered_map<WeldKey, int, WeldKeyHash> globalIds(&arena);
+  globalIds.reserve(localVertices);
+
+  for (size_t f = 0; f < uses.size(); ++f)
+  {
+    const WeldedFace& welded = *uses[f].welded;
+    std::vector<int>& remap = remaps[f];
+    remap.resize(welded.vertices.size());
+    for (size_t i = 0; i < welded.vertices.size(); ++i)
+    {
+      const auto inserted = globalIds.emplace(welded.keys[i], static_cast<int>(vertices.size()));
+      if (inserted.second)
+        vertices.push_back(welded.vertices[i]);
+      remap[i] = inserted.first->second;
+    }
+  }
+}
+
+std::shared_ptr<TriMesh> FaceMeshCache::buildTriMesh(const TopoDS_Shape& shape, const MeshingParams& params,
+                                                     FaceMeshStats* stats)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  FaceMeshStats local;
+  const std::vector<FaceUse> uses = prepareFaces(shape, params, false, local);
+
+  auto mesh = std::make_shared<TriMesh>();
+  std::vector<std::vector<int>> remaps;
+  mergeFaces(uses, mesh->vertices, remaps);
+
+  size_t indexCount = 0;
+  for (const FaceUse& use : uses)
+    indexCount += use.welded->triangles.size();
+  mesh->indices.reserve(indexCount);
+
+  for (size_t f = 0; f < uses.size(); ++f)
+  {
+    const std::vector<int>& tris = uses[f].welded->triangles;
+    const std::vector<int>& remap = remaps[f];
+    const bool reversed = uses[f].orientation == TopAbs_REVERSED;
+    for (size_t t = 0; t + 2 < tris.size(); t += 3)
+    {
+      mesh->indices.push_back(remap[tris[t]]);
+      mesh->indices.push_back(remap[tris[t + (reversed ? 2 : 1)]]);
+      mesh->indices.push_back(remap[tris[t + (reversed ? 1 : 2)]]);
+    }
+  }
+
+  local.elapsedMs = timer.elapsed();
+  if (stats)
+    *stats = local;
+  return mesh;
+}
+
+std::shared_ptr<QuadMesh> FaceMeshCache::buildQuadMesh(const TopoDS_Shape& shape, const MeshingParams& params,
+                                                       FaceMeshStats* stats)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  FaceMeshStats local;
+  const std::vector<FaceUse> uses = prepareFaces(shape, params, true, local);
+
+  auto quad = std::make_shared<QuadMesh>();
+  std::vector<std::vector<int>> remaps;
+  mergeFaces(uses, quad->vertices, remaps);
+
+  std::vector<bool> used;
+  for (size_t f = 0; f < uses.size(); ++f)
+  {
+    const std::vector<int>& tris = uses[f].welded->triangles;
+    const std::vector<int>& remap = remaps[f];
+    const bool reversed = uses[f].orientation == TopAbs_REVERSED;
+    const size_t triCount = tris.size() / 3;
+    used.assign(triCount, false);
+
+    for (const QuadCandidate& c : *uses[f].candidates)
+    {
+      if (used[c.t0] || used[c.t1])
+        continue;
+      used[c.t0] = true;
+      used[c.t1] = true;
+
+      quad->quadIndices.push_back(remap[c.other0]);
+      quad->quadIndices.push_back(remap[reversed ? c.sharedB : c.sharedA]);
+      quad->quadIndices.push_back(remap[c.other1]);
+      quad->quadIndices.push_back(remap[reversed ? c.sharedA : c.sharedB]);
+    }
+
+    for (size_t t = 0; t < triCount; ++t)
+    {
+      if (used[t])
+        continue;
+      quad->triIndices.push_back(remap[tris[t * 3]]);
+      quad->triIndices.push_back(remap[tris[t * 3 + (reversed ? 2 : 1)]]);
+      quad->triIndices.push_back(remap[tris[t * 3 + (reversed ? 1 : 2)]]);
+    }
+  }
+
+  local.elapsedMs = timer.elapsed();
+  if (stats)
+    *stats = local;
+  return quad;
+}
+
+qint64 FaceMeshCache::memoryBytes() const
+{
+  qint64 total = 0;
+  for (const auto& entry : m_faces)
+  {
+    const FaceRecord& record = entry.second;
+    // The triangulation the face is displayed with is accounted with the scene, not the cache.
+    TopLoc_Location loc;
+    const Handle(Poly_Triangulation) displayed = BRep_Tool::Triangulation(record.face, loc);
+    for (const TriangulationVariant& v : record.triangulations)
+    {
+      if (v.triangulation.IsNull() || v.triangulation == displayed)
+        continue;
+      total += static_cast<qint64>(v.triangulation->NbNodes()) * static_cast<qint64>(sizeof(gp_Pnt))
+               + static_cast<qint64>(v.triangulation->NbTriangles()) * static_cast<qint64>(sizeof(Poly_Triangle));
+    }
+    for (const WeldVariant& v : record.welds)
+    {
+      for (const InstanceWeld& instance : v.instances)
+      {
+        total += static_cast<qint64>(instance.welded->vertices.capacity() * sizeof(gp_Pnt)
+                                     + instance.welded->keys.capacity() * sizeof(WeldKey)
+                                     + instance.welded->triangles.capacity() * sizeof(int));
+        if (instance.candidates)
+          total += static_cast<qint64>(instance.candidates->capacity() * sizeof(QuadCandidate));
+      }
+    }
+  }
+  return total;
+}
@@ -0,0 +1,85 @@
+#include "Occt/MemoryBudget.h"
+
+#include <QStringList>
+
+static QString formatBytes(qint64 bytes)
+{
+  return QStringLiteral("%1 MB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+qint64 MemoryBudget::usedBytes() const
+{
+  qint64 total = 0;
+  for (const Stage& s : m_stages)
+    total += s.bytes;
+  return total;
+}
+
+bool MemoryBudget::fits(qint64 extraBytes) const
+{
+  return !isLimited() || usedBytes() + extraBytes <= m_limitBytes;
+}
+
+bool MemoryBudget::check(const QString& what, qint64 extraBytes, QString* errorText) const
+{
+  if (fits(extraBytes))
+    return true;
+  if (errorText)
+  {
+    *errorText = QStringLiteral("%1 需要约 %2，已用 %3，超出内存预算 %4")
+                   .arg(what, formatBytes(extraBytes), formatBytes(usedBytes()), formatBytes(m_limitBytes));
+  }
+  return false;
+}
+
+void MemoryBudget::record(const QString& stage, qint64 bytes)
+{
+  Stage* target = nullptr;
+  for (Stage& s : m_stages)
+  {
+    if (s.name == stage)
+    {
+      target = &s;
+      break;
+    }
+  }
+  if (!target)
+  {
+    m_stages.push_back(Stage{stage, 0, 0});
+    target = &m_stages.back();
+  }
+
+  target->bytes = bytes;
+  target->peakBytes = qMax(target->peakBytes, bytes);
+  m_peakBytes = qMax(m_peakBytes, usedBytes());
+}
+
+void MemoryBudget::clear()
+{
+  m_stages.clear();
+  m_peakBytes = 0;
+}
+
+QString MemoryBudget::summary() const
+{
+  QStringList parts;
+  for (const Stage& s : m_stages)
+    parts << QStringLiteral("%1 %2（峰值 %3）").arg(s.name, formatBytes(s.bytes), formatBytes(s.peakBytes));
+  QString text = QStringLiteral("内存：当前 %1，峰值 %2").arg(formatBytes(usedBytes()), formatBytes(m_peakBytes));
+  if (isLimited())
+    text += QStringLiteral("，预算 %1").arg(formatBytes(m_limitBytes));
+  if (!parts.isEmpty())
+    text += QStringLiteral("；") + parts.join(QStringLiteral("，"));
+  return text;
+}
+
+qint64 MemoryBudget::bytesOf(const TriMesh& mesh)
+{
+  return static_cast<qint64>(mesh.vertices.capacity() * sizeof(gp_Pnt) + mesh.indices.capacity() * sizeof(int));
+}
+
+qint64 MemoryBudget::bytesOf(const QuadMesh& mesh)
+{
+  return static_cast<qint64>(mesh.vertices.capacity() * sizeof(gp_Pnt)
+                             + (mesh.quadIndices.capacity() + mesh.triIndices.capacity()) * sizeof(int));
+}
@@ -0,0 +1,404 @@
+#include "Occt/MeshBuilder.h"
+
+#include <cmath>
+#include <memory_resource>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Tool.hxx>
+#include <IGESControl_Controller.hxx>
+#include <IGESControl_Reader.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopAbs_Orientation.hxx>
+
+#include "Occt/MemoryBudget.h"
+
+// Rough per-entry cost of a node-based hash map (key, value, next pointer, bucket slot).
+static constexpr qint64 kHashEntryOverhead = 24;
+
+static gp_Pnt transformedNode(const Handle(Poly_Triangulation)& tri, int nodeIndex1, const gp_Trsf& trsf)
+{
+  gp_Pnt p = tri->Node(nodeIndex1);
+  p.Transform(trsf);
+  return p;
+}
+
+static bool isCoplanar(const gp_Pnt& a, const gp_Pnt& b, const gp_Pnt& c, const gp_Pnt& d)
+{
+  const gp_Vec ab(a, b);
+  const gp_Vec ac(a, c);
+  const gp_Vec n = ab.Crossed(ac);
+  const double n2 = n.SquareMagnitude();
+  if (n2 < 1e-18)
+    return false;
+
+  const gp_Vec ad(a, d);
+  const double dist = std::abs(ad.Dot(n)) / std::sqrt(n2);
+  return dist < 1e-6;
+}
+
+bool MeshBuilder::canMergeTriangles(const gp_Pnt& sharedA, const gp_Pnt& sharedB, const gp_Pnt& other0,
+                                    const gp_Pnt& other1)
+{
+  if (!isCoplanar(sharedA, sharedB, other0, other1))
+    return false;
+
+  const gp_Vec n1(gp_Vec(sharedA, other0).Crossed(gp_Vec(sharedA, sharedB)));
+  const gp_Vec n2(gp_Vec(sharedB, sharedA).Crossed(gp_Vec(sharedB, other1)));
+  const double n1m = n1.Magnitude();
+  const double n2m = n2.Magnitude();
+  if (n1m < 1e-12 || n2m < 1e-12)
+    return false;
+  const double cosang = std::abs(n1.Dot(n2) / (n1m * n2m));
+  return cosang > 0.99;
+}
+
+void MeshBuilder::warmUp()
+{
+  IGESControl_Controller::Init();
+  IGESControl_Reader reader;
+  (void)reader;
+}
+
+bool MeshBuilder::readIgsFile(const QString& filePath, TopoDS_Shape& shape, QString* errorText)
+{
+  IGESControl_Reader reader;
+  const IFSelect_ReturnStatus status = reader.ReadFile(filePath.toUtf8().constData());
+  if (status != IFSelect_RetDone)
+  {
+    if (errorText)
+      *errorText = QStringLiteral("IGES读取失败：%1").arg(filePath);
+    return false;
+  }
+
+  reader.TransferRoots();
+  shape = reader.OneShape();
+  if (shape.IsNull())
+  {
+    if (errorText)
+      *errorText = QStringLiteral("IGES文件未生成有效Shape");
+    return false;
+  }
+  return true;
+}
+
+std::shared_ptr<TriMesh> MeshBuilder::buildTriMesh(const TopoDS_Shape& shape, const MeshingParams& params)
+{
+  return buildTriMesh(shape, params, nullptr, nullptr);
+}
+
+std::shared_ptr<TriMesh> MeshBuilder::buildTriMesh(const TopoDS_Shape& shape, const MeshingParams& params,
+                                                   MemoryBudget* budget, QString* errorText)
+{
+  BRepMesh_IncrementalMesh mesher(shape, params.linearDeflection, false, params.angularDeflection, true);
+  mesher.Perform();
+
+  struct FaceTriangulation
+  {
+    TopoDS_Face face;
+    Handle(Poly_Triangulation) tri;
+    gp_Trsf trsf;
+  };
+
+  std::vector<FaceTriangulation> faces;
+  size_t totalNodes = 0;
+  size_t totalTriangles = 0;
+  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+  {
+    const TopoDS_Face face = TopoDS::Face(exp.Current());
+    TopLoc_Location loc;
+    const Handle(Poly_Triangulation) tri = BRep_Tool::Triangulation(face, loc);
+    if (tri.IsNull())
+      continue;
+    faces.push_back(FaceTriangulation{face, tri, loc.Transformation()});
+    totalNodes += static_cast<size_t>(tri->NbNodes());
+    totalTriangles += static_cast<size_t>(tri->NbTriangles());
+  }
+
+  struct Key
+  {
+    long long x = 0;
+    long long y = 0;
+    long long z = 0;
+    bool operator==(const Key& o) const { return x == o.x && y == o.y && z == o.z; }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& k) const noexcept
+    {
+      const size_t hx = static_cast<size_t>(k.x) * 73856093ULL;
+      const size_t hy = static_cast<size_t>(k.y) * 19349663ULL;
+      const size_t hz = static_cast<size_t>(k.z) * 83492791ULL;
+      return hx ^ hy ^ hz;
+    }
+  };
+
+  // Upper bound: every face node survives welding.
+  const qint64 weldEstimate =
+    static_cast<qint64>(totalNodes) * static_cast<qint64>(sizeof(gp_Pnt) + sizeof(Key) + sizeof(int) + kHashEntryOverhead)
+    + static_cast<qint64>(totalTriangles * 3 * sizeof(int));
+  if (budget && !budget->check(MemoryBudget::kStageWeldArena, weldEstimate, errorText))
+    return nullptr;
+
+  auto mesh = std::make_shared<TriMesh>();
+  mesh->vertices.reserve(totalNodes);
+  mesh->indices.reserve(totalTriangles * 3);
+
+  const double scale = 1.0 / params.weldTolerance;
+  auto keyOf = [&](const gp_Pnt& p) -> Key {
+    return Key{
+      static_cast<long long>(std::llround(p.X() * scale)),
+      static_cast<long long>(std::llround(p.Y() * scale)),
+      static_cast<long long>(std::llround(p.Z() * scale)),
+    };
+  };
+
+  // The weld map lives in a per-load arena and is handed back to the heap in one release().
+  CountingResource arenaUpstream;
+  std::pmr::monotonic_buffer_resource arena(&arenaUpstream);
+  {
+    std::pmr::unordered_map<Key, int, KeyHash> vertexMap(&arena);
+    vertexMap.reserve(totalNodes);
+
+    for (const FaceTriangulation& entry : faces)
+    {
+      const Handle(Poly_Triangulation)& tri = entry.tri;
+      const int nbTriangles = tri->NbTriangles();
+      for (int i = 1; i <= nbTriangles; ++i)
+      {
+        int n1 = 0, n2 = 0, n3 = 0;
+        tri->Triangle(i).Get(n1, n2, n3);
+        if (entry.face.Orientation() == TopAbs_REVERSED)
+          std::swap(n2, n3);
+
+        const gp_Pnt pts[3] = {
+          transformedNode(tri, n1, entry.trsf),
+          transformedNode(tri, n2, entry.trsf),
+          transformedNode(tri, n3, entry.trsf),
+        };
+
+        for (int k = 0; k < 3; ++k)
+        {
+          const auto inserted = vertexMap.emplace(keyOf(pts[k]), static_cast<int>(mesh->vertices.size()));
+          if (inserted.second)
+            mesh->vertices.push_back(pts[k]);
+          mesh->indices.push_back(inserted.first->second);
+        }
+      }
+    }
+
+    if (budget)
+      budget->record(MemoryBudget::kStageWeldArena, static_cast<qint64>(arenaUpstream.allocatedBytes()));
+  }
+  arena.release();
+
+  if (budget)
+  {
+    budget->release(MemoryBudget::kStageWeldArena);
+    budget->record(MemoryBudget::kStageTriMesh, MemoryBudget::bytesOf(*mesh));
+  }
+  return mesh;
+}
+
+qint64 MeshBuilder::triangulationBytes(const TopoDS_Shape& shape)
+{
+  // Instances share one triangulation; count each once.
+  std::unordered_set<const Poly_Triangulation*> seen;
+  qint64 bytes = 0;
+  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+  {
+    TopLoc_Location loc;
+    const Handle(Poly_Triangulation) tri = BRep_Tool::Triangulation(TopoDS::Face(exp.Current()), loc);
+    if (tri.IsNull() || !seen.insert(tri.get()).second)
+      continue;
+    bytes += static_cast<qint64>(tri->NbNodes()) * static_cast<qint64>(sizeof(gp_Pnt))
+             + static_cast<qint64>(tri->NbTriangles()) * static_cast<qint64>(sizeof(Poly_Triangle));
+  }
+  return bytes;
+}
+
+std::shared_ptr<TriMesh> MeshBuilder::collectTriangles(const TopoDS_Shape& shape)
+{
+  auto mesh = std::make_shared<TriMesh>();
+  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+  {
+    const TopoDS_Face face = TopoDS::Face(exp.Current());
+    TopLoc_Location loc;
+    const Handle(Poly_Triangulation) tri = BRep_Tool::Triangulation(face, loc);
+    if (tri.IsNull())
+      continue;
+
+    const gp_Trsf trsf = loc.Transformation();
+    const int base = static_cast<int>(mesh->vertices.size());
+    for (int i = 1; i <= tri->NbNodes(); ++i)
+      mesh->vertices.push_back(transformedNode(tri, i, trsf));
+    for (int i = 1; i <= tri->NbTriangles(); ++i)
+    {
+      int n1 = 0, n2 = 0, n3 = 0;
+      tri->Triangle(i).Get(n1, n2, n3);
+      if (face.Orientation() == TopAbs_REVERSED)
+        std::swap(n2, n3);
+      mesh->indices.push_back(base + n1 - 1);
+      mesh->indices.push_back(base + n2 - 1);
+      mesh->indices.push_back(base + n3 - 1);
+    }
+  }
+  return mesh;
+}
+
+std::shared_ptr<QuadMesh> MeshBuilder::buildQuadMesh(const TriMesh& triMesh)
+{
+  return buildQuadMesh(triMesh, nullptr, nullptr);
+}
+
+std::shared_ptr<QuadMesh> MeshBuilder::buildQuadMesh(const TriMesh& triMesh, MemoryBudget* budget, QString* errorText)
+{
+  struct EdgeKey
+  {
+    int a = 0;
+    int b = 0;
+    bool operator==(const EdgeKey& o) const { return a == o.a && b == o.b; }
+  };
+
+  struct EdgeHash
+  {
+    size_t operator()(const EdgeKey& e) const noexcept
+    {
+      return (static_cast<size_t>(e.a) << 32) ^ static_cast<size_t>(e.b);
+    }
+  };
+
+  struct TriRef
+  {
+    int triIndex = 0;
+    int localEdge = 0;
+  };
+
+  struct QuadCandidate
+  {
+    int t0 = -1;
+    int t1 = -1;
+    int sharedA = -1;
+    int sharedB = -1;
+    int other0 = -1;
+    int other1 = -1;
+  };
+
+  const int triCount = static_cast<int>(triMesh.indices.size() / 3);
+  // A closed manifold mesh has 3/2 edges per triangle, and every shared edge can yield a candidate.
+  const size_t edgeCount = static_cast<size_t>(triCount) * 3 / 2;
+  const qint64 quadEstimate =
+    static_cast<qint64>(triMesh.vertices.size() * sizeof(gp_Pnt) + triMesh.indices.size() * sizeof(int))
+    + static_cast<qint64>(triCount) * 2 * static_cast<qint64>(sizeof(EdgeKey) + sizeof(TriRef) + kHashEntryOverhead)
+    + static_cast<qint64>(edgeCount) * static_cast<qint64>(sizeof(QuadCandidate));
+  if (budget && !budget->check(MemoryBudget::kStageQuadMesh, quadEstimate, errorText))
+    return nullptr;
+
+  auto quad = std::make_shared<QuadMesh>();
+  quad->vertices = triMesh.vertices;
+
+  CountingResource arenaUpstream;
+  std::pmr::monotonic_buffer_resource arena(&arenaUpstream);
+  {
+    std::pmr::vector<bool> used(static_cast<size_t>(triCount), false, &arena);
+    std::pmr::unordered_map<EdgeKey, TriRef, EdgeHash> edgeOwner(&arena);
+    edgeOwner.reserve(static_cast<size_t>(triCount) * 2);
+
+    auto edgeKey = [](int u, int v) -> EdgeKey {
+      if (u < v)
+        return {u, v};
+      return {v, u};
+    };
+
+    auto triVertex = [&](int t, int i) -> int { return triMesh.indices[static_cast<size_t>(t) * 3 + i]; };
+
+    std::pmr::vector<QuadCandidate> candidates(&arena);
+    candidates.reserve(edgeCount);
+
+    for (int t = 0; t < triCount; ++t)
+    {
+      const int v0 = triVertex(t, 0);
+      const int v1 = triVertex(t, 1);
+      const int v2 = triVertex(t, 2);
+
+      const int ev[3][2] = {{v0, v1}, {v1, v2}, {v2, v0}};
+      for (int e = 0; e < 3; ++e)
+      {
+        const EdgeKey k = edgeKey(ev[e][0], ev[e][1]);
+        auto it = edgeOwner.find(k);
+        if (it == edgeOwner.end())
+        {
+          edgeOwner.emplace(k, TriRef{t, e});
+        }
+        else
+        {
+          const int t2 = it->second.triIndex;
+          if (t2 == t)
+            continue;
+
+          const int a = k.a;
+          const int b = k.b;
+
+          const int tv0 = triVertex(t, 0);
+          const int tv1 = triVertex(t, 1);
+          const int tv2 = triVertex(t, 2);
+          const int ov_t = (tv0 != a && tv0 != b) ? tv0 : (tv1 != a && tv1 != b) ? tv1 : tv2;
+
+          const int uv0 = triVertex(t2, 0);
+          const int uv1 = triVertex(t2, 1);
+          const int uv2 = triVertex(t2, 2);
+          const int ov_t2 = (uv0 != a && uv0 != b) ? uv0 : (uv1 != a && uv1 != b) ? uv1 : uv2;
+
+          candidates.push_back(QuadCandidate{t2, t, a, b, ov_t2, ov_t});
+        }
+      }
+    }
+
+    for (const auto& c : candidates)
+    {
+      if (c.t0 < 0 || c.t1 < 0)
+        continue;
+      if (used[c.t0] || used[c.t1])
+        continue;
+      if (!canMergeTriangles(quad->vertices[c.sharedA], quad->vertices[c.sharedB], quad->vertices[c.other0],
+                             quad->vertices[c.other1]))
+        continue;
+
+      used[c.t0] = true;
+      used[c.t1] = true;
+
+      quad->quadIndices.push_back(c.other0);
+      quad->quadIndices.push_back(c.sharedA);
+      quad->quadIndices.push_back(c.other1);
+      quad->quadIndices.push_back(c.sharedB);
+    }
+
+    for (int t = 0; t < triCount; ++t)
+    {
+      if (used[t])
+        continue;
+      quad->triIndices.push_back(triVertex(t, 0));
+      quad->triIndices.push_back(triVertex(t, 1));
+      quad->triIndices.push_back(triVertex(t, 2));
+    }
+
+    if (budget)
+      budget->record(MemoryBudget::kStageQuadArena, static_cast<qint64>(arenaUpstream.allocatedBytes()));
+  }
+  // The edge map, candidates and flags go back to the heap together.
+  arena.release();
+
+  if (budget)
+  {
+    budget->release(MemoryBudget::kStageQuadArena);
+    budget->record(MemoryBudget::kStageQuadMesh, MemoryBudget::bytesOf(*quad));
+  }
+  return quad;
+}
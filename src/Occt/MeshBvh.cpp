@@ -0,0 +1,727 @@
+#include "Occt/MeshBvh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define MESH_BVH_USE_SSE 1
+  #include <xmmintrin.h>
+#endif
+
+#include "Occt/MeshTypes.h"
+#include "Occt/ParallelFor.h"
+
+namespace
+{
+constexpr int kBinCount = 16;
+constexpr int kMaxLeafSize = 8;
+constexpr int kMaxDepth = 60;
+constexpr int kStackSize = kMaxDepth + 4;
+constexpr int kParallelBuildThreshold = 1 << 16;
+constexpr float kTraversalCost = 1.0f;
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+struct Aabb
+{
+  float mn[3] = {kInf, kInf, kInf};
+  float mx[3] = {-kInf, -kInf, -kInf};
+
+  void grow(const float p[3])
+  {
+    for (int a = 0; a < 3; ++a)
+    {
+      mn[a] = std::min(mn[a], p[a]);
+      mx[a] = std::max(mx[a], p[a]);
+    }
+  }
+
+  void grow(const Aabb& b)
+  {
+    for (int a = 0; a < 3; ++a)
+    {
+      mn[a] = std::min(mn[a], b.mn[a]);
+      mx[a] = std::max(mx[a], b.mx[a]);
+    }
+  }
+
+  bool isEmpty() const { return mn[0] > mx[0]; }
+
+  float halfArea() const
+  {
+    if (isEmpty())
+      return 0.0f;
+    const float dx = mx[0] - mn[0];
+    const float dy = mx[1] - mn[1];
+    const float dz = mx[2] - mn[2];
+    return dx * dy + dy * dz + dz * dx;
+  }
+};
+
+void toFloat3(const gp_Pnt& p, float out[3])
+{
+  out[0] = static_cast<float>(p.X());
+  out[1] = static_cast<float>(p.Y());
+  out[2] = static_cast<float>(p.Z());
+}
+
+float dot3(const float a[3], const float b[3])
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void cross3(const float a[3], const float b[3], float out[3])
+{
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
+}
+} // namespace
+
+struct MeshBvh::Builder
+{
+  std::vector<Aabb> triBounds;
+  std::vector<std::array<float, 3>> centroids;
+  std::vector<int> order;
+
+  static void setBounds(Node& n, const Aabb& b)
+  {
+    for (int a = 0; a < 3; ++a)
+    {
+      n.bmin[a] = b.mn[a];
+      n.bmax[a] = b.mx[a];
+    }
+  }
+
+  static Aabb boundsOf(const Node& n)
+  {
+    Aabb b;
+    for (int a = 0; a < 3; ++a)
+    {
+      b.mn[a] = n.bmin[a];
+      b.mx[a] = n.bmax[a];
+    }
+    return b;
+  }
+
+  void subdivide(std::vector<Node>& nodes, int nodeIdx, int depth)
+  {
+    const Node node = nodes[nodeIdx];
+    const int first = node.leftOrFirst;
+    const int count = node.count;
+    if (count <= 2 || depth >= kMaxDepth)
+      return;
+
+    Aabb centroidBounds;
+    for (int i = first; i < first + count; ++i)
+      centroidBounds.grow(centroids[order[i]].data());
+
+    int axis = 0;
+    float extent = centroidBounds.mx[0] - centroidBounds.mn[0];
+    for (int a = 1; a < 3; ++a)
+    {
+      const float e = centroidBounds.mx[a] - centroidBounds.mn[a];
+      if (e > extent)
+      {
+        extent = e;
+        axis = a;
+      }
+    }
+    if (!(extent > 0.0f))
+      return;
+
+    Aabb binBounds[kBinCount];
+    int binCounts[kBinCount] = {};
+    const float binScale = kBinCount / extent;
+    const float axisMin = centroidBounds.mn[axis];
+    auto binOf = [&](int prim) -> int {
+      const int b = static_cast<int>((centroids[prim][axis] - axisMin) * binScale);
+      return std::min(kBinCount - 1, std::max(0, b));
+    };
+
+    for (int i = first; i < first + count; ++i)
+    {
+      const int prim = order[i];
+      const int b = binOf(prim);
+      ++binCounts[b];
+      binBounds[b].grow(triBounds[prim]);
+    }
+
+    float rightArea[kBinCount - 1];
+    int rightCount[kBinCount - 1];
+    Aabb rightAcc;
+    int rightSum = 0;
+    for (int b = kBinCount - 1; b > 0; --b)
+    {
+      rightAcc.grow(binBounds[b]);
+      rightSum += binCounts[b];
+      rightArea[b - 1] = rightAcc.halfArea();
+      rightCount[b - 1] = rightSum;
+    }
+
+    int bestSplit = -1;
+    float bestCost = kInf;
+    Aabb leftAcc;
+    int leftSum = 0;
+    for (int b = 0; b < kBinCount - 1; ++b)
+    {
+      leftAcc.grow(binBounds[b]);
+      leftSum += binCounts[b];
+      if (leftSum == 0 || rightCount[b] == 0)
+        continue;
+      const float cost = leftSum * leftAcc.halfArea() + rightCount[b] * rightArea[b];
+      if (cost < bestCost)
+      {
+        bestCost = cost;
+        bestSplit = b;
+      }
+    }
+
+    const float parentArea = boundsOf(node).halfArea();
+    const float leafCost = count * parentArea;
+    if (bestSplit < 0 || (kTraversalCost * parentArea + bestCost >= leafCost && count <= kMaxLeafSize))
+      return;
+
+    int* begin = order.data() + first;
+    int* mid = std::partition(begin, begin + count, [&](int prim) { return binOf(prim) <= bestSplit; });
+    const int leftCount = static_cast<int>(mid - begin);
+    if (leftCount == 0 || leftCount == count)
+      return;
+
+    Aabb leftBounds;
+    Aabb rightBounds;
+    for (int b = 0; b < kBinCount; ++b)
+      (b <= bestSplit ? leftBounds : rightBounds).grow(binBounds[b]);
+
+    Node left{};
+    setBounds(left, leftBounds);
+    left.leftOrFirst = first;
+    left.count = leftCount;
+
+    Node right{};
+    setBounds(right, rightBounds);
+    right.leftOrFirst = first + leftCount;
+    right.count = count - leftCount;
+
+    if (count >= kParallelBuildThreshold && (1 << depth) < static_cast<int>(parallelWorkerCount()))
+    {
+      std::vector<Node> leftNodes(1, left);
+      std::vector<Node> rightNodes(1, right);
+      auto leftTask = std::async(std::launch::async, [&]() { subdivide(leftNodes, 0, depth + 1); });
+      subdivide(rightNodes, 0, depth + 1);
+      leftTask.get();
+      splice(nodes, nodeIdx, leftNodes, rightNodes);
+      return;
+    }
+
+    const int leftIdx = static_cast<int>(nodes.size());
+    nodes.push_back(left);
+    nodes.push_back(right);
+    nodes[nodeIdx].leftOrFirst = leftIdx;
+    nodes[nodeIdx].count = 0;
+
+    subdivide(nodes, leftIdx, depth + 1);
+    subdivide(nodes, leftIdx + 1, depth + 1);
+  }
+
+  // Appends two independently built subtrees (each rooted at index 0) below nodes[parentIdx],
+  // keeping both roots adjacent as the traversal expects.
+  static void splice(std::vector<Node>& nodes, int parentIdx, const std::vector<Node>& leftNodes,
+                     const std::vector<Node>& rightNodes)
+  {
+    const int base = static_cast<int>(nodes.size());
+    const int leftSize = static_cast<int>(leftNodes.size());
+
+    auto remapLeft = [&](int i) { return i == 0 ? base : base + 1 + i; };
+    auto remapRight = [&](int i) { return i == 0 ? base + 1 : base + leftSize + i; };
+
+    nodes.reserve(nodes.size() + leftNodes.size() + rightNodes.size());
+    nodes.push_back(leftNodes[0]);
+    nodes.push_back(rightNodes[0]);
+    nodes.insert(nodes.end(), leftNodes.begin() + 1, leftNodes.end());
+    nodes.insert(nodes.end(), rightNodes.begin() + 1, rightNodes.end());
+
+    for (int i = 0; i < leftSize; ++i)
+    {
+      Node& n = nodes[remapLeft(i)];
+      if (n.count == 0)
+        n.leftOrFirst = remapLeft(n.leftOrFirst);
+    }
+    for (int i = 0; i < static_cast<int>(rightNodes.size()); ++i)
+    {
+      Node& n = nodes[remapRight(i)];
+      if (n.count == 0)
+        n.leftOrFirst = remapRight(n.leftOrFirst);
+    }
+
+    nodes[parentIdx].leftOrFirst = base;
+    nodes[parentIdx].count = 0;
+  }
+};
+
+void MeshBvh::clear()
+{
+  m_nodes.clear();
+  m_nodes.shrink_to_fit();
+  m_tris.clear();
+  m_tris.shrink_to_fit();
+  m_triIds.clear();
+  m_triIds.shrink_to_fit();
+}
+
+size_t MeshBvh::memoryBytes() const
+{
+  return m_nodes.capacity() * sizeof(Node) + m_tris.capacity() * sizeof(PackedTri)
+         + m_triIds.capacity() * sizeof(int);
+}
+
+void MeshBvh::build(const TriMesh& mesh)
+{
+  clear();
+
+  const int triCount = static_cast<int>(mesh.indices.size() / 3);
+  if (triCount == 0)
+    return;
+
+  Builder b;
+  b.triBounds.resize(triCount);
+  b.centroids.resize(triCount);
+  b.order.resize(triCount);
+
+  Aabb rootBounds;
+  std::mutex rootBoundsMutex;
+  parallelFor(static_cast<size_t>(triCount), 4096, [&](size_t begin, size_t end) {
+    Aabb acc;
+    for (size_t t = begin; t < end; ++t)
+    {
+      Aabb tb;
+      for (int k = 0; k < 3; ++k)
+      {
+        float p[3];
+        toFloat3(mesh.vertices[mesh.indices[t * 3 + k]], p);
+        tb.grow(p);
+      }
+      b.triBounds[t] = tb;
+      for (int a = 0; a < 3; ++a)
+        b.centroids[t][a] = 0.5f * (tb.mn[a] + tb.mx[a]);
+      b.order[t] = static_cast<int>(t);
+      acc.grow(tb);
+    }
+    std::lock_guard<std::mutex> lock(rootBoundsMutex);
+    rootBounds.grow(acc);
+  });
+
+  m_nodes.reserve(static_cast<size_t>(triCount) / 2 + 1);
+  Node root{};
+  Builder::setBounds(root, rootBounds);
+  root.leftOrFirst = 0;
+  root.count = triCount;
+  m_nodes.push_back(root);
+  b.subdivide(m_nodes, 0, 0);
+  m_nodes.shrink_to_fit();
+
+  m_tris.resize(triCount);
+  m_triIds.resize(triCount);
+  parallelFor(static_cast<size_t>(triCount), 4096, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      const int t = b.order[i];
+      float p0[3], p1[3], p2[3];
+      toFloat3(mesh.vertices[mesh.indices[static_cast<size_t>(t) * 3 + 0]], p0);
+      toFloat3(mesh.vertices[mesh.indices[static_cast<size_t>(t) * 3 + 1]], p1);
+      toFloat3(mesh.vertices[mesh.indices[static_cast<size_t>(t) * 3 + 2]], p2);
+      PackedTri& pt = m_tris[i];
+      for (int a = 0; a < 3; ++a)
+      {
+        pt.v0[a] = p0[a];
+        pt.e1[a] = p1[a] - p0[a];
+        pt.e2[a] = p2[a] - p0[a];
+      }
+      m_triIds[i] = t;
+    }
+  });
+}
+
+bool MeshBvh::bounds(gp_Pnt& minPnt, gp_Pnt& maxPnt) const
+{
+  if (m_nodes.empty())
+    return false;
+  const Node& r = m_nodes.front();
+  minPnt.SetCoord(r.bmin[0], r.bmin[1], r.bmin[2]);
+  maxPnt.SetCoord(r.bmax[0], r.bmax[1], r.bmax[2]);
+  return true;
+}
+
+namespace
+{
+struct RayState
+{
+  float org[4];
+  float dir[4];
+  float invDir[4];
+#ifdef MESH_BVH_USE_SSE
+  __m128 org4;
+  __m128 invDir4;
+#endif
+
+  explicit RayState(const MeshRay& ray)
+  {
+    toFloat3(ray.origin, org);
+    dir[0] = static_cast<float>(ray.direction.X());
+    dir[1] = static_cast<float>(ray.direction.Y());
+    dir[2] = static_cast<float>(ray.direction.Z());
+    org[3] = 0.0f;
+    dir[3] = 0.0f;
+    for (int a = 0; a < 3; ++a)
+      invDir[a] = 1.0f / dir[a];
+    invDir[3] = 0.0f;
+#ifdef MESH_BVH_USE_SSE
+    org4 = _mm_loadu_ps(org);
+    invDir4 = _mm_loadu_ps(invDir);
+#endif
+  }
+};
+} // namespace
+
+MeshQueryHit MeshBvh::rayCast(const MeshRay& ray, double maxDistance) const
+{
+  MeshQueryHit hit;
+  if (m_nodes.empty())
+    return hit;
+
+  const RayState rs(ray);
+  float tBest = std::isfinite(maxDistance) ? static_cast<float>(maxDistance) : kInf;
+  int bestIndex = -1;
+
+  // Returns the entry distance into the node box, or +inf when the ray misses it.
+  auto hitBox = [&](const Node& n) -> float {
+#ifdef MESH_BVH_USE_SSE
+    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.bmin), rs.org4), rs.invDir4);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.bmax), rs.org4), rs.invDir4);
+    const __m128 lo = _mm_min_ps(t0, t1);
+    const __m128 hi = _mm_max_ps(t0, t1);
+    const __m128 tNear = _mm_max_ss(_mm_max_ss(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 1, 1, 1))),
+                                    _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 2, 2, 2)));
+    const __m128 tFar = _mm_min_ss(_mm_min_ss(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 1, 1, 1))),
+                                   _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 2, 2, 2)));
+    const float tn = std::max(_mm_cvtss_f32(tNear), 0.0f);
+    const float tf = std::min(_mm_cvtss_f32(tFar), tBest);
+#else
+    float tn = 0.0f;
+    float tf = tBest;
+    for (int a = 0; a < 3; ++a)
+    {
+      const float t0 = (n.bmin[a] - rs.org[a]) * rs.invDir[a];
+      const float t1 = (n.bmax[a] - rs.org[a]) * rs.invDir[a];
+      tn = std::max(tn, std::min(t0, t1));
+      tf = std::min(tf, std::max(t0, t1));
+    }
+#endif
+    return tn <= tf ? tn : kInf;
+  };
+
+  auto hitTriangle = [&](const PackedTri& tri) -> float {
+    float pvec[3];
+    cross3(rs.dir, tri.e2, pvec);
+    const float det = dot3(tri.e1, pvec);
+    if (std::abs(det) < 1e-20f)
+      return kInf;
+    const float invDet = 1.0f / det;
+    const float tvec[3] = {rs.org[0] - tri.v0[0], rs.org[1] - tri.v0[1], rs.org[2] - tri.v0[2]};
+    const float u = dot3(tvec, pvec) * invDet;
+    if (u < 0.0f || u > 1.0f)
+      return kInf;
+    float qvec[3];
+    cross3(tvec, tri.e1, qvec);
+    const float v = dot3(rs.dir, qvec) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+      return kInf;
+    const float t = dot3(tri.e2, qvec) * invDet;
+    return t >= 0.0f ? t : kInf;
+  };
+
+  int stack[kStackSize];
+  float stackDist[kStackSize];
+  int sp = 0;
+
+  if (hitBox(m_nodes[0]) == kInf)
+    return hit;
+
+  int idx = 0;
+  for (;;)
+  {
+    const Node& n = m_nodes[idx];
+    if (n.count > 0)
+    {
+      for (int i = n.leftOrFirst; i < n.leftOrFirst + n.count; ++i)
+      {
+        const float t = hitTriangle(m_tris[i]);
+        if (t < tBest)
+        {
+          tBest = t;
+          bestIndex = i;
+        }
+      }
+    }
+    else
+    {
+      int nearIdx = n.leftOrFirst;
+      int farIdx = n.leftOrFirst + 1;
+      float dNear = hitBox(m_nodes[nearIdx]);
+      float dFar = hitBox(m_nodes[farIdx]);
+      if (dFar < dNear)
+      {
+        std::swap(nearIdx, farIdx);
+        std::swap(dNear, dFar);
+      }
+      if (dNear != kInf)
+      {
+        if (dFar != kInf)
+        {
+          stack[sp] = farIdx;
+          stackDist[sp] = dFar;
+          ++sp;
+        }
+        idx = nearIdx;
+        continue;
+      }
+    }
+
+    bool found = false;
+    while (sp > 0)
+    {
+      --sp;
+      if (stackDist[sp] < tBest)
+      {
+        idx = stack[sp];
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      break;
+  }
+
+  if (bestIndex < 0)
+    return hit;
+
+  hit.triangle = m_triIds[bestIndex];
+  hit.distance = tBest;
+  hit.point = ray.origin.Translated(gp_Vec(ray.direction) * hit.distance);
+  return hit;
+}
+
+MeshQueryHit MeshBvh::closestPoint(const gp_Pnt& p, double maxDistance) const
+{
+  MeshQueryHit hit;
+  if (m_nodes.empty())
+    return hit;
+
+  float q[3];
+  toFloat3(p, q);
+  float bestD2 = std::isfinite(maxDistance) ? static_cast<float>(maxDistance * maxDistance) : kInf;
+  float bestPnt[3] = {0.0f, 0.0f, 0.0f};
+  int bestIndex = -1;
+
+  auto boxDist2 = [&](const Node& n) -> float {
+    float d2 = 0.0f;
+    for (int a = 0; a < 3; ++a)
+    {
+      const float d = std::max(std::max(n.bmin[a] - q[a], q[a] - n.bmax[a]), 0.0f);
+      d2 += d * d;
+    }
+    return d2;
+  };
+
+  // Ericson, "Real-Time Collision Detection", 5.1.5, expressed with the packed edge vectors.
+  auto closestOnTriangle = [&](const PackedTri& tri, float out[3]) {
+    const float* e1 = tri.e1;
+    const float* e2 = tri.e2;
+    const float ap[3] = {q[0] - tri.v0[0], q[1] - tri.v0[1], q[2] - tri.v0[2]};
+    auto emit = [&](float s, float t) {
+      for (int a = 0; a < 3; ++a)
+        out[a] = tri.v0[a] + s * e1[a] + t * e2[a];
+    };
+
+    const float d1 = dot3(e1, ap);
+    const float d2 = dot3(e2, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+      return emit(0.0f, 0.0f);
+
+    const float bp[3] = {ap[0] - e1[0], ap[1] - e1[1], ap[2] - e1[2]};
+    const float d3 = dot3(e1, bp);
+    const float d4 = dot3(e2, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+      return emit(1.0f, 0.0f);
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+      return emit(d1 / (d1 - d3), 0.0f);
+
+    const float cp[3] = {ap[0] - e2[0], ap[1] - e2[1], ap[2] - e2[2]};
+    const float d5 = dot3(e1, cp);
+    const float d6 = dot3(e2, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+      return emit(0.0f, 1.0f);
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+      return emit(0.0f, d2 / (d2 - d6));
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+      const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+      return emit(1.0f - w, w);
+    }
+
+    const float denom = va + vb + vc;
+    if (std::abs(denom) < 1e-30f)
+      return emit(0.0f, 0.0f);
+    const float inv = 1.0f / denom;
+    emit(vb * inv, vc * inv);
+  };
+
+  int stack[kStackSize];
+  float stackDist[kStackSize];
+  int sp = 0;
+
+  if (boxDist2(m_nodes[0]) > bestD2)
+    return hit;
+
+  int idx = 0;
+  for (;;)
+  {
+    const Node& n = m_nodes[idx];
+    if (n.count > 0)
+    {
+      for (int i = n.leftOrFirst; i < n.leftOrFirst + n.count; ++i)
+      {
+        float c[3];
+        closestOnTriangle(m_tris[i], c);
+        const float d[3] = {c[0] - q[0], c[1] - q[1], c[2] - q[2]};
+        const float d2 = dot3(d, d);
+        if (d2 <= bestD2)
+        {
+          bestD2 = d2;
+          bestIndex = i;
+          std::copy(c, c + 3, bestPnt);
+        }
+      }
+    }
+    else
+    {
+      int nearIdx = n.leftOrFirst;
+      int farIdx = n.leftOrFirst + 1;
+      float dNear = boxDist2(m_nodes[nearIdx]);
+      float dFar = boxDist2(m_nodes[farIdx]);
+      if (dFar < dNear)
+      {
+        std::swap(nearIdx, farIdx);
+        std::swap(dNear, dFar);
+      }
+      if (dNear <= bestD2)
+      {
+        if (dFar <= bestD2)
+        {
+          stack[sp] = farIdx;
+          stackDist[sp] = dFar;
+          ++sp;
+        }
+        idx = nearIdx;
+        continue;
+      }
+    }
+
+    bool found = false;
+    while (sp > 0)
+    {
+      --sp;
+      if (stackDist[sp] <= bestD2)
+      {
+        idx = stack[sp];
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      break;
+  }
+
+  if (bestIndex < 0)
+    return hit;
+
+  hit.triangle = m_triIds[bestIndex];
+  hit.point.SetCoord(bestPnt[0], bestPnt[1], bestPnt[2]);
+  hit.distance = p.Distance(hit.point);
+  return hit;
+}
+
+void MeshBvh::trianglesInBox(const gp_Pnt& minPnt, const gp_Pnt& maxPnt, std::vector<int>& triangles) const
+{
+  if (m_nodes.empty())
+    return;
+
+  float qmin[3], qmax[3];
+  toFloat3(minPnt, qmin);
+  toFloat3(maxPnt, qmax);
+
+  auto overlaps = [&](const float mn[3], const float mx[3]) {
+    return mn[0] <= qmax[0] && mx[0] >= qmin[0] && mn[1] <= qmax[1] && mx[1] >= qmin[1] && mn[2] <= qmax[2]
+           && mx[2] >= qmin[2];
+  };
+
+  int stack[kStackSize];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0)
+  {
+    const Node& n = m_nodes[stack[--sp]];
+    if (!overlaps(n.bmin, n.bmax))
+      continue;
+
+    if (n.count == 0)
+    {
+      stack[sp++] = n.leftOrFirst;
+      stack[sp++] = n.leftOrFirst + 1;
+      continue;
+    }
+
+    for (int i = n.leftOrFirst; i < n.leftOrFirst + n.count; ++i)
+    {
+      const PackedTri& tri = m_tris[i];
+      float mn[3], mx[3];
+      for (int a = 0; a < 3; ++a)
+      {
+        const float v1 = tri.v0[a] + tri.e1[a];
+        const float v2 = tri.v0[a] + tri.e2[a];
+        mn[a] = std::min(tri.v0[a], std::min(v1, v2));
+        mx[a] = std::max(tri.v0[a], std::max(v1, v2));
+      }
+      if (overlaps(mn, mx))
+        triangles.push_back(m_triIds[i]);
+    }
+  }
+}
+
+std::vector<MeshQueryHit> MeshBvh::rayCastBatch(const std::vector<MeshRay>& rays, double maxDistance) const
+{
+  std::vector<MeshQueryHit> hits(rays.size());
+  parallelFor(rays.size(), 256, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      hits[i] = rayCast(rays[i], maxDistance);
+  });
+  return hits;
+}
+
+std::vector<MeshQueryHit> MeshBvh::closestPointBatch(const std::vector<gp_Pnt>& points, double maxDistance) const
+{
+  std::vector<MeshQueryHit> hits(points.size());
+  parallelFor(points.size(), 256, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      hits[i] = closestPoint(points[i], maxDistance);
+  });
+  return hits;
+}
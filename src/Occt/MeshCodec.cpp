@@ -0,0 +1,383 @@
+#include "Occt/MeshCodec.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include <QFile>
+#include <QtEndian>
+
+#include "Occt/MeshTypes.h"
+#include "Occt/ParallelFor.h"
+
+// File layout (little endian):
+//   "IMZ1", u32 positionBits, u64 vertexCount, u64 triangleCount, f64 origin[3], f64 step,
+//   u32 verticesPerBlock, u32 trianglesPerBlock,
+//   per vertex block: u32 payloadBytes; per triangle block: u32 payloadBytes, u32 firstNewVertex,
+//   then every payload (qCompress output of a varint stream) in the same order.
+// Blocks are independent, so they are encoded and decoded in parallel.
+
+namespace
+{
+const char kMagic[4] = {'I', 'M', 'Z', '1'};
+constexpr size_t kHeaderBytes = 64;
+constexpr uint32_t kVerticesPerBlock = 1 << 16;
+constexpr uint32_t kTrianglesPerBlock = 1 << 16;
+// Bounds on the varint stream behind one vertex (three deltas) or one triangle (three references).
+constexpr uint64_t kMinItemBytes = 3;
+constexpr uint64_t kMaxItemBytes = 30;
+// zlib cannot expand its input by more than this factor.
+constexpr uint64_t kMaxInflateRatio = 1032;
+
+uint64_t zigzag(int64_t v)
+{
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v)
+{
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void putVarint(std::vector<uchar>& out, uint64_t v)
+{
+  while (v >= 0x80)
+  {
+    out.push_back(static_cast<uchar>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<uchar>(v));
+}
+
+bool getVarint(const uchar*& p, const uchar* end, uint64_t& v)
+{
+  v = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    if (p >= end)
+      return false;
+    const uchar b = *p++;
+    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+template <typename T>
+void putLE(QByteArray& out, T value)
+{
+  uchar bytes[sizeof(T)];
+  qToLittleEndian(value, bytes);
+  out.append(reinterpret_cast<const char*>(bytes), static_cast<int>(sizeof(T)));
+}
+
+void putDouble(QByteArray& out, double value)
+{
+  quint64 bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  putLE<quint64>(out, bits);
+}
+
+template <typename T>
+T getLE(const char* p)
+{
+  return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(p));
+}
+
+double getDouble(const char* p)
+{
+  const quint64 bits = getLE<quint64>(p);
+  double value = 0.0;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+size_t blockCount(uint64_t items, uint32_t perBlock)
+{
+  return static_cast<size_t>((items + perBlock - 1) / perBlock);
+}
+
+QByteArray compressStream(const std::vector<uchar>& stream)
+{
+  return qCompress(stream.data(), static_cast<int>(stream.size()));
+}
+
+void setError(QString* errorText, const QString& message)
+{
+  if (errorText)
+    *errorText = message;
+}
+} // namespace
+
+QByteArray MeshCodec::encode(const TriMesh& mesh, int positionBits)
+{
+  positionBits = std::clamp(positionBits, 1, 31);
+  const size_t vertexCount = mesh.vertices.size();
+  const size_t triCount = mesh.indices.size() / 3;
+
+  const double inf = std::numeric_limits<double>::infinity();
+  double bmin[3] = {inf, inf, inf};
+  double bmax[3] = {-inf, -inf, -inf};
+  std::mutex boundsMutex;
+  parallelFor(vertexCount, 1 << 15, [&](size_t begin, size_t end) {
+    double lmin[3] = {inf, inf, inf};
+    double lmax[3] = {-inf, -inf, -inf};
+    for (size_t i = begin; i < end; ++i)
+    {
+      const double c[3] = {mesh.vertices[i].X(), mesh.vertices[i].Y(), mesh.vertices[i].Z()};
+      for (int a = 0; a < 3; ++a)
+      {
+        lmin[a] = std::min(lmin[a], c[a]);
+        lmax[a] = std::max(lmax[a], c[a]);
+      }
+    }
+    std::lock_guard<std::mutex> lock(boundsMutex);
+    for (int a = 0; a < 3; ++a)
+    {
+      bmin[a] = std::min(bmin[a], lmin[a]);
+      bmax[a] = std::max(bmax[a], lmax[a]);
+    }
+  });
+  if (vertexCount == 0)
+    std::fill(bmin, bmin + 3, 0.0);
+
+  double extent = 0.0;
+  for (int a = 0; a < 3; ++a)
+    extent = std::max(extent, bmax[a] - bmin[a]);
+  const double maxLevel = static_cast<double>((1u << positionBits) - 1);
+  const double step = extent > 0.0 ? extent / maxLevel : 1.0;
+
+  const size_t vertexBlocks = blockCount(vertexCount, kVerticesPerBlock);
+  std::vector<QByteArray> vertexPayloads(vertexBlocks);
+  parallelFor(vertexBlocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+    std::vector<uchar> stream;
+    for (size_t block = blockBegin; block < blockEnd; ++block)
+    {
+      stream.clear();
+      int64_t prev[3] = {0, 0, 0};
+      const size_t end = std::min(vertexCount, (block + 1) * kVerticesPerBlock);
+      for (size_t i = block * kVerticesPerBlock; i < end; ++i)
+      {
+        const double c[3] = {mesh.vertices[i].X(), mesh.vertices[i].Y(), mesh.vertices[i].Z()};
+        for (int a = 0; a < 3; ++a)
+        {
+          const int64_t q = std::llround(std::min((c[a] - bmin[a]) / step, maxLevel));
+          putVarint(stream, zigzag(q - prev[a]));
+          prev[a] = q;
+        }
+      }
+      vertexPayloads[block] = compressStream(stream);
+    }
+  });
+
+  // Vertices are usually numbered in order of first use, so a reference to the next unused id is
+  // coded as 0 and older ones as small distances back from it.
+  const size_t triBlocks = blockCount(triCount, kTrianglesPerBlock);
+  std::vector<uint32_t> firstNewVertex(triBlocks, 0);
+  int64_t highWater = 0;
+  for (size_t t = 0; t < triCount; ++t)
+  {
+    if (t % kTrianglesPerBlock == 0)
+      firstNewVertex[t / kTrianglesPerBlock] = static_cast<uint32_t>(highWater);
+    for (int k = 0; k < 3; ++k)
+      highWater = std::max<int64_t>(highWater, mesh.indices[t * 3 + k] + 1);
+  }
+
+  std::vector<QByteArray> triPayloads(triBlocks);
+  parallelFor(triBlocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+    std::vector<uchar> stream;
+    for (size_t block = blockBegin; block < blockEnd; ++block)
+    {
+      stream.clear();
+      int64_t next = firstNewVertex[block];
+      const size_t end = std::min(triCount, (block + 1) * kTrianglesPerBlock) * 3;
+      for (size_t i = block * kTrianglesPerBlock * 3; i < end; ++i)
+      {
+        const int64_t idx = mesh.indices[i];
+        putVarint(stream, zigzag(next - idx));
+        next = std::max(next, idx + 1);
+      }
+      triPayloads[block] = compressStream(stream);
+    }
+  });
+
+  QByteArray out;
+  out.append(kMagic, 4);
+  putLE<quint32>(out, static_cast<quint32>(positionBits));
+  putLE<quint64>(out, vertexCount);
+  putLE<quint64>(out, triCount);
+  for (int a = 0; a < 3; ++a)
+    putDouble(out, bmin[a]);
+  putDouble(out, step);
+  putLE<quint32>(out, kVerticesPerBlock);
+  putLE<quint32>(out, kTrianglesPerBlock);
+  for (const QByteArray& payload : vertexPayloads)
+    putLE<quint32>(out, static_cast<quint32>(payload.size()));
+  for (size_t block = 0; block < triBlocks; ++block)
+  {
+    putLE<quint32>(out, static_cast<quint32>(triPayloads[block].size()));
+    putLE<quint32>(out, firstNewVertex[block]);
+  }
+  for (const QByteArray& payload : vertexPayloads)
+    out.append(payload);
+  for (const QByteArray& payload : triPayloads)
+    out.append(payload);
+  return out;
+}
+
+bool MeshCodec::decode(const char* data, size_t size, TriMesh& mesh, QString* errorText)
+{
+  if (size < kHeaderBytes || std::memcmp(data, kMagic, 4) != 0)
+  {
+    setError(errorText, QStringLiteral("无法识别的压缩网格文件"));
+    return false;
+  }
+
+  const uint32_t positionBits = getLE<quint32>(data + 4);
+  const uint64_t vertexCount = getLE<quint64>(data + 8);
+  const uint64_t triCount = getLE<quint64>(data + 16);
+  const double origin[3] = {getDouble(data + 24), getDouble(data + 32), getDouble(data + 40)};
+  const double step = getDouble(data + 48);
+  const uint32_t verticesPerBlock = getLE<quint32>(data + 56);
+  const uint32_t trianglesPerBlock = getLE<quint32>(data + 60);
+  if (positionBits < 1 || positionBits > 31 || vertexCount > static_cast<uint64_t>(INT_MAX)
+      || triCount > static_cast<uint64_t>(INT_MAX) / 3 || verticesPerBlock == 0 || trianglesPerBlock == 0)
+  {
+    setError(errorText, QStringLiteral("压缩网格文件头无效"));
+    return false;
+  }
+
+  const size_t vertexBlocks = blockCount(vertexCount, verticesPerBlock);
+  const size_t triBlocks = blockCount(triCount, trianglesPerBlock);
+  const size_t tableBytes = vertexBlocks * 4 + triBlocks * 8;
+  if (size - kHeaderBytes < tableBytes)
+  {
+    setError(errorText, QStringLiteral("压缩网格文件已损坏"));
+    return false;
+  }
+
+  // Check every block against the counts it has to carry before the counts size any allocation:
+  // each payload must lie inside the file, fit qUncompress's int length, and announce an uncompressed
+  // size (qCompress's big-endian prefix) that both matches its item count and is reachable from its
+  // compressed size.
+  const char* table = data + kHeaderBytes;
+  std::vector<size_t> offsets(vertexBlocks + triBlocks + 1, kHeaderBytes + tableBytes);
+  std::vector<uint32_t> firstNewVertex(triBlocks);
+  for (size_t block = 0; block < vertexBlocks + triBlocks; ++block)
+  {
+    uint32_t bytes = 0;
+    uint64_t items = 0;
+    if (block < vertexBlocks)
+    {
+      bytes = getLE<quint32>(table + block * 4);
+      items = std::min<uint64_t>(vertexCount - block * static_cast<uint64_t>(verticesPerBlock), verticesPerBlock);
+    }
+    else
+    {
+      const size_t triBlock = block - vertexBlocks;
+      const char* entry = table + vertexBlocks * 4 + triBlock * 8;
+      bytes = getLE<quint32>(entry);
+      firstNewVertex[triBlock] = getLE<quint32>(entry + 4);
+      items = std::min<uint64_t>(triCount - triBlock * static_cast<uint64_t>(trianglesPerBlock), trianglesPerBlock);
+    }
+
+    bool valid = bytes > 4 && bytes <= static_cast<uint32_t>(INT_MAX) && bytes <= size - offsets[block];
+    if (valid)
+    {
+      const uint64_t streamBytes = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data + offsets[block]));
+      valid = streamBytes >= items * kMinItemBytes && streamBytes <= items * kMaxItemBytes
+              && streamBytes <= (bytes - 4) * kMaxInflateRatio;
+    }
+    if (block >= vertexBlocks)
+      valid = valid && firstNewVertex[block - vertexBlocks] <= vertexCount;
+    if (!valid)
+    {
+      setError(errorText, QStringLiteral("压缩网格文件已损坏"));
+      return false;
+    }
+    offsets[block + 1] = offsets[block] + bytes;
+  }
+
+  mesh.vertices.resize(static_cast<size_t>(vertexCount));
+  mesh.indices.resize(static_cast<size_t>(triCount) * 3);
+
+  std::vector<char> blockOk(vertexBlocks + triBlocks, 0);
+  parallelFor(vertexBlocks + triBlocks, 1, [&](size_t blockBegin, size_t blockEnd) {
+    for (size_t block = blockBegin; block < blockEnd; ++block)
+    {
+      const QByteArray stream = qUncompress(reinterpret_cast<const uchar*>(data + offsets[block]),
+                                            static_cast<int>(offsets[block + 1] - offsets[block]));
+      const uchar* p = reinterpret_cast<const uchar*>(stream.constData());
+      const uchar* end = p + stream.size();
+      bool ok = true;
+
+      if (block < vertexBlocks)
+      {
+        const int64_t maxLevel = (int64_t(1) << positionBits) - 1;
+        int64_t q[3] = {0, 0, 0};
+        const size_t last = std::min<size_t>(vertexCount, (block + 1) * static_cast<size_t>(verticesPerBlock));
+        for (size_t i = block * verticesPerBlock; ok && i < last; ++i)
+        {
+          for (int a = 0; a < 3 && ok; ++a)
+          {
+            uint64_t v = 0;
+            ok = getVarint(p, end, v);
+            // Encoded levels stay in [0, maxLevel]; checking the delta first also keeps the sum from overflowing.
+            const int64_t delta = unzigzag(v);
+            ok = ok && delta >= -q[a] && delta <= maxLevel - q[a];
+            if (ok)
+              q[a] += delta;
+          }
+          mesh.vertices[i].SetCoord(origin[0] + q[0] * step, origin[1] + q[1] * step, origin[2] + q[2] * step);
+        }
+      }
+      else
+      {
+        const size_t triBlock = block - vertexBlocks;
+        int64_t next = firstNewVertex[triBlock];
+        const size_t last = std::min<size_t>(triCount, (triBlock + 1) * static_cast<size_t>(trianglesPerBlock)) * 3;
+        for (size_t i = triBlock * trianglesPerBlock * 3; ok && i < last; ++i)
+        {
+          uint64_t v = 0;
+          ok = getVarint(p, end, v);
+          const int64_t back = unzigzag(v);
+          ok = ok && back <= next && back > next - static_cast<int64_t>(vertexCount);
+          if (!ok)
+            break;
+          const int64_t idx = next - back;
+          mesh.indices[i] = static_cast<int>(idx);
+          next = std::max(next, idx + 1);
+        }
+      }
+      blockOk[block] = ok && p == end;
+    }
+  });
+
+  if (std::find(blockOk.begin(), blockOk.end(), 0) != blockOk.end())
+  {
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    setError(errorText, QStringLiteral("压缩网格文件已损坏"));
+    return false;
+  }
+  return true;
+}
+
+bool MeshCodec::writeFile(const QString& filePath, const TriMesh& mesh, int positionBits, QString* errorText)
+{
+  const QByteArray encoded = encode(mesh, positionBits);
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(encoded) != encoded.size())
+  {
+    setError(errorText, QStringLiteral("无法写入文件：%1").arg(filePath));
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,352 @@
+#include "Occt/MeshRasterizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define MESH_RASTER_USE_SSE 1
+  #include <emmintrin.h>
+#endif
+
+#include "Occt/MeshTypes.h"
+#include "Occt/ParallelFor.h"
+
+namespace
+{
+constexpr int kTileSize = 64;
+constexpr double kFitMargin = 0.01;
+constexpr uint32_t kBackgroundColor = 0xff333333u;
+constexpr double kBaseColor[3] = {0.80, 0.68, 0.40};
+constexpr double kAmbient = 0.25;
+
+struct ViewBasis
+{
+  gp_Vec right;
+  gp_Vec up;
+  gp_Vec forward;
+};
+
+// Same orientation as the default V3d_View (V3d_XposYnegZpos) that OcctViewerWidget fits.
+ViewBasis defaultViewBasis()
+{
+  ViewBasis b;
+  b.forward = gp_Vec(-1.0, 1.0, -1.0) / std::sqrt(3.0);
+  b.right = b.forward.Crossed(gp_Vec(0.0, 0.0, 1.0));
+  b.right.Normalize();
+  b.up = b.right.Crossed(b.forward);
+  return b;
+}
+
+struct ScreenVertex
+{
+  float x;
+  float y;
+  float z;
+};
+
+struct SetupTri
+{
+  float ea[3];
+  float eb[3];
+  float ec[3];
+  float za;
+  float zb;
+  float zc;
+  int minX;
+  int minY;
+  int maxX;
+  int maxY;
+  uint32_t color;
+};
+
+uint32_t shadeColor(double intensity)
+{
+  const auto channel = [&](double c) {
+    return static_cast<uint32_t>(std::clamp(c * intensity, 0.0, 1.0) * 255.0 + 0.5);
+  };
+  return 0xff000000u | (channel(kBaseColor[0]) << 16) | (channel(kBaseColor[1]) << 8) | channel(kBaseColor[2]);
+}
+
+bool setupTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, int width, int height,
+                   SetupTri& t)
+{
+  const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+  if (std::abs(area) < 1e-12f)
+    return false;
+
+  t.minX = std::max(0, static_cast<int>(std::floor(std::min({v0.x, v1.x, v2.x}))));
+  t.minY = std::max(0, static_cast<int>(std::floor(std::min({v0.y, v1.y, v2.y}))));
+  t.maxX = std::min(width - 1, static_cast<int>(std::ceil(std::max({v0.x, v1.x, v2.x}))));
+  t.maxY = std::min(height - 1, static_cast<int>(std::ceil(std::max({v0.y, v1.y, v2.y}))));
+  if (t.minX > t.maxX || t.minY > t.maxY)
+    return false;
+
+  // Edge i is opposite vertex i, so its value at a pixel is that vertex's barycentric weight times the area.
+  const ScreenVertex* v[3] = {&v0, &v1, &v2};
+  const float sign = area > 0.0f ? 1.0f : -1.0f;
+  for (int i = 0; i < 3; ++i)
+  {
+    const ScreenVertex& a = *v[(i + 1) % 3];
+    const ScreenVertex& b = *v[(i + 2) % 3];
+    t.ea[i] = sign * (a.y - b.y);
+    t.eb[i] = sign * (b.x - a.x);
+    t.ec[i] = sign * (a.x * b.y - a.y * b.x);
+  }
+
+  const float invArea = 1.0f / std::abs(area);
+  t.za = (t.ea[0] * v0.z + t.ea[1] * v1.z + t.ea[2] * v2.z) * invArea;
+  t.zb = (t.eb[0] * v0.z + t.eb[1] * v1.z + t.eb[2] * v2.z) * invArea;
+  t.zc = (t.ec[0] * v0.z + t.ec[1] * v1.z + t.ec[2] * v2.z) * invArea;
+  return true;
+}
+
+void rasterizeInTile(const SetupTri& t, int tileX0, int tileY0, float* depth, uint32_t* color)
+{
+  const int x0 = std::max(t.minX, tileX0);
+  const int x1 = std::min(t.maxX, tileX0 + kTileSize - 1);
+  const int y0 = std::max(t.minY, tileY0);
+  const int y1 = std::min(t.maxY, tileY0 + kTileSize - 1);
+  if (x0 > x1 || y0 > y1)
+    return;
+
+#ifdef MESH_RASTER_USE_SSE
+  const int xs = tileX0 + ((x0 - tileX0) & ~3);
+  const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128i colorV = _mm_set1_epi32(static_cast<int>(t.color));
+  const __m128 ea0 = _mm_set1_ps(t.ea[0]);
+  const __m128 ea1 = _mm_set1_ps(t.ea[1]);
+  const __m128 ea2 = _mm_set1_ps(t.ea[2]);
+  const __m128 za = _mm_set1_ps(t.za);
+
+  for (int y = y0; y <= y1; ++y)
+  {
+    const float py = y + 0.5f;
+    const __m128 row0 = _mm_set1_ps(t.eb[0] * py + t.ec[0]);
+    const __m128 row1 = _mm_set1_ps(t.eb[1] * py + t.ec[1]);
+    const __m128 row2 = _mm_set1_ps(t.eb[2] * py + t.ec[2]);
+    const __m128 rowZ = _mm_set1_ps(t.zb * py + t.zc);
+    float* depthRow = depth + (y - tileY0) * kTileSize - tileX0;
+    uint32_t* colorRow = color + (y - tileY0) * kTileSize - tileX0;
+
+    for (int x = xs; x <= x1; x += 4)
+    {
+      const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+      const __m128 w0 = _mm_add_ps(_mm_mul_ps(ea0, px), row0);
+      const __m128 w1 = _mm_add_ps(_mm_mul_ps(ea1, px), row1);
+      const __m128 w2 = _mm_add_ps(_mm_mul_ps(ea2, px), row2);
+      const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                                       _mm_cmpge_ps(w2, zero));
+      if (_mm_movemask_ps(inside) == 0)
+        continue;
+
+      const __m128 z = _mm_add_ps(_mm_mul_ps(za, px), rowZ);
+      const __m128 oldZ = _mm_load_ps(depthRow + x);
+      const __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, oldZ));
+      if (_mm_movemask_ps(pass) == 0)
+        continue;
+
+      _mm_store_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, oldZ)));
+      const __m128i passI = _mm_castps_si128(pass);
+      const __m128i oldC = _mm_load_si128(reinterpret_cast<const __m128i*>(colorRow + x));
+      _mm_store_si128(reinterpret_cast<__m128i*>(colorRow + x),
+                      _mm_or_si128(_mm_and_si128(passI, colorV), _mm_andnot_si128(passI, oldC)));
+    }
+  }
+#else
+  for (int y = y0; y <= y1; ++y)
+  {
+    const float py = y + 0.5f;
+    float* depthRow = depth + (y - tileY0) * kTileSize - tileX0;
+    uint32_t* colorRow = color + (y - tileY0) * kTileSize - tileX0;
+    for (int x = x0; x <= x1; ++x)
+    {
+      const float px = x + 0.5f;
+      if (t.ea[0] * px + t.eb[0] * py + t.ec[0] < 0.0f || t.ea[1] * px + t.eb[1] * py + t.ec[1] < 0.0f
+          || t.ea[2] * px + t.eb[2] * py + t.ec[2] < 0.0f)
+        continue;
+      const float z = t.za * px + t.zb * py + t.zc;
+      if (z < depthRow[x])
+      {
+        depthRow[x] = z;
+        colorRow[x] = t.color;
+      }
+    }
+  }
+#endif
+}
+} // namespace
+
+QImage MeshRasterizer::render(const TriMesh& mesh, int width, int height)
+{
+  QImage image(width, height, QImage::Format_RGB32);
+  if (image.isNull())
+    return image;
+  image.fill(kBackgroundColor);
+
+  const size_t vertexCount = mesh.vertices.size();
+  const size_t triCount = mesh.indices.size() / 3;
+  if (vertexCount == 0 || triCount == 0)
+    return image;
+
+  const double inf = std::numeric_limits<double>::infinity();
+  double bmin[3] = {inf, inf, inf};
+  double bmax[3] = {-inf, -inf, -inf};
+  std::mutex boundsMutex;
+  parallelFor(vertexCount, 1 << 15, [&](size_t begin, size_t end) {
+    double lmin[3] = {inf, inf, inf};
+    double lmax[3] = {-inf, -inf, -inf};
+    for (size_t i = begin; i < end; ++i)
+    {
+      const gp_Pnt& p = mesh.vertices[i];
+      const double c[3] = {p.X(), p.Y(), p.Z()};
+      for (int a = 0; a < 3; ++a)
+      {
+        lmin[a] = std::min(lmin[a], c[a]);
+        lmax[a] = std::max(lmax[a], c[a]);
+      }
+    }
+    std::lock_guard<std::mutex> lock(boundsMutex);
+    for (int a = 0; a < 3; ++a)
+    {
+      bmin[a] = std::min(bmin[a], lmin[a]);
+      bmax[a] = std::max(bmax[a], lmax[a]);
+    }
+  });
+
+  // Fit the projected bounding box corners, as V3d_View::FitAll does.
+  const ViewBasis view = defaultViewBasis();
+  double minR = inf, maxR = -inf, minU = inf, maxU = -inf;
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    const gp_Vec c((corner & 1) ? bmax[0] : bmin[0], (corner & 2) ? bmax[1] : bmin[1],
+                   (corner & 4) ? bmax[2] : bmin[2]);
+    minR = std::min(minR, c.Dot(view.right));
+    maxR = std::max(maxR, c.Dot(view.right));
+    minU = std::min(minU, c.Dot(view.up));
+    maxU = std::max(maxU, c.Dot(view.up));
+  }
+  const double extR = std::max(maxR - minR, 1e-12);
+  const double extU = std::max(maxU - minU, 1e-12);
+  const double scale = std::min(width / extR, height / extU) * (1.0 - 2.0 * kFitMargin);
+  const double centerR = 0.5 * (minR + maxR);
+  const double centerU = 0.5 * (minU + maxU);
+
+  std::vector<ScreenVertex> screen(vertexCount);
+  parallelFor(vertexCount, 1 << 15, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      const gp_Vec p(mesh.vertices[i].XYZ());
+      screen[i].x = static_cast<float>(0.5 * width + (p.Dot(view.right) - centerR) * scale);
+      screen[i].y = static_cast<float>(0.5 * height - (p.Dot(view.up) - centerU) * scale);
+      screen[i].z = static_cast<float>(p.Dot(view.forward));
+    }
+  });
+
+  const int tilesX = (width + kTileSize - 1) / kTileSize;
+  const int tilesY = (height + kTileSize - 1) / kTileSize;
+  const int tileCount = tilesX * tilesY;
+
+  // Setup and binning: every chunk of triangles owns one list per tile, so no locking is needed.
+  const size_t chunkCount = std::min(parallelWorkerCount(), std::max<size_t>(1, triCount / 4096));
+  const size_t chunkSize = (triCount + chunkCount - 1) / chunkCount;
+  std::vector<SetupTri> tris(triCount);
+  std::vector<std::vector<std::vector<uint32_t>>> bins(chunkCount, std::vector<std::vector<uint32_t>>(tileCount));
+
+  parallelFor(chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+    for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+    {
+      auto& chunkBins = bins[chunk];
+      const size_t triEnd = std::min(triCount, (chunk + 1) * chunkSize);
+      for (size_t t = chunk * chunkSize; t < triEnd; ++t)
+      {
+        const int i0 = mesh.indices[t * 3 + 0];
+        const int i1 = mesh.indices[t * 3 + 1];
+        const int i2 = mesh.indices[t * 3 + 2];
+        SetupTri& st = tris[t];
+        if (!setupTriangle(screen[i0], screen[i1], screen[i2], width, height, st))
+          continue;
+
+        const gp_Vec n = gp_Vec(mesh.vertices[i0], mesh.vertices[i1]).Crossed(gp_Vec(mesh.vertices[i0], mesh.vertices[i2]));
+        const double nm = n.Magnitude();
+        const double cosang = nm > 0.0 ? std::abs(n.Dot(view.forward)) / nm : 0.0;
+        st.color = shadeColor(kAmbient + (1.0 - kAmbient) * cosang);
+
+        for (int ty = st.minY / kTileSize; ty <= st.maxY / kTileSize; ++ty)
+          for (int tx = st.minX / kTileSize; tx <= st.maxX / kTileSize; ++tx)
+            chunkBins[ty * tilesX + tx].push_back(static_cast<uint32_t>(t));
+      }
+    }
+  });
+
+  uchar* bits = image.bits();
+  const auto bytesPerLine = image.bytesPerLine();
+  std::atomic<int> nextTile{0};
+
+  parallelFor(parallelWorkerCount(), 1, [&](size_t, size_t) {
+    alignas(16) float depth[kTileSize * kTileSize];
+    alignas(16) uint32_t color[kTileSize * kTileSize];
+
+    for (int tile = nextTile++; tile < tileCount; tile = nextTile++)
+    {
+      const int tileX0 = (tile % tilesX) * kTileSize;
+      const int tileY0 = (tile / tilesX) * kTileSize;
+      bool touched = false;
+      std::fill(std::begin(depth), std::end(depth), std::numeric_limits<float>::infinity());
+      std::fill(std::begin(color), std::end(color), kBackgroundColor);
+
+      for (const auto& chunkBins : bins)
+      {
+        for (const uint32_t t : chunkBins[tile])
+        {
+          rasterizeInTile(tris[t], tileX0, tileY0, depth, color);
+          touched = true;
+        }
+      }
+      if (!touched)
+        continue;
+
+      const int rowCount = std::min(kTileSize, height - tileY0);
+      const int colCount = std::min(kTileSize, width - tileX0);
+      for (int r = 0; r < rowCount; ++r)
+      {
+        auto* dst = reinterpret_cast<uint32_t*>(bits + (tileY0 + r) * bytesPerLine) + tileX0;
+        std::memcpy(dst, color + r * kTileSize, colCount * sizeof(uint32_t));
+      }
+    }
+  });
+
+  return image;
+}
+
+bool MeshRasterizer::renderToPng(const QString& filePath, const TriMesh& mesh, int width, int height,
+                                 QString* errorText)
+{
+  if (width <= 0 || height <= 0 || width > kMaxImageSize || height > kMaxImageSize)
+  {
+    if (errorText)
+      *errorText = QStringLiteral("无效的图像尺寸：%1x%2（最大 %3）").arg(width).arg(height).arg(kMaxImageSize);
+    return false;
+  }
+
+  const QImage image = render(mesh, width, height);
+  if (image.isNull())
+  {
+    if (errorText)
+      *errorText = QStringLiteral("无法分配 %1x%2 的图像").arg(width).arg(height);
+    return false;
+  }
+  if (!image.save(filePath, "PNG"))
+  {
+    if (errorText)
+      *errorText = QStringLiteral("无法写入文件：%1").arg(filePath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,776 @@
+#include "Occt/MeshReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QtGlobal>
+
+#include "Occt/MeshCodec.h"
+#include "Occt/MeshTypes.h"
+#include "Occt/ParallelFor.h"
+
+namespace
+{
+constexpr size_t kMinObjChunkBytes = 4 << 20;
+
+bool isBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipBlanks(const char* p, const char* end)
+{
+  while (p < end && isBlank(*p))
+    ++p;
+  return p;
+}
+
+const char* lineEnd(const char* p, const char* end)
+{
+  const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+  return nl ? static_cast<const char*>(nl) : end;
+}
+
+// Plain decimal/scientific notation only; returns nullptr when no number starts at p.
+const char* parseDouble(const char* p, const char* end, double& out)
+{
+  static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  p = skipBlanks(p, end);
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    ++p;
+  }
+
+  uint64_t mantissa = 0;
+  int significant = 0;
+  int exponent = 0;
+  bool anyDigit = false;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p)
+  {
+    anyDigit = true;
+    if (significant < 19)
+    {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      if (mantissa != 0)
+        ++significant;
+    }
+    else
+    {
+      ++exponent;
+    }
+  }
+  if (p < end && *p == '.')
+  {
+    for (++p; p < end && *p >= '0' && *p <= '9'; ++p)
+    {
+      anyDigit = true;
+      if (significant < 19)
+      {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        if (mantissa != 0)
+          ++significant;
+        --exponent;
+      }
+    }
+  }
+  if (!anyDigit)
+    return nullptr;
+
+  if (p < end && (*p == 'e' || *p == 'E'))
+  {
+    const char* q = p + 1;
+    bool expNegative = false;
+    if (q < end && (*q == '-' || *q == '+'))
+    {
+      expNegative = *q == '-';
+      ++q;
+    }
+    if (q < end && *q >= '0' && *q <= '9')
+    {
+      int e = 0;
+      for (; q < end && *q >= '0' && *q <= '9'; ++q)
+        e = std::min(e * 10 + (*q - '0'), 100000);
+      exponent += expNegative ? -e : e;
+      p = q;
+    }
+  }
+
+  double value = static_cast<double>(mantissa);
+  if (exponent != 0)
+  {
+    if (exponent > 0 && exponent <= 22)
+      value *= kPow10[exponent];
+    else if (exponent < 0 && exponent >= -22)
+      value /= kPow10[-exponent];
+    else
+      value *= std::pow(10.0, exponent);
+  }
+  out = negative ? -value : value;
+  return p;
+}
+
+const char* parseInt(const char* p, const char* end, long long& out)
+{
+  p = skipBlanks(p, end);
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    ++p;
+  }
+  if (p >= end || *p < '0' || *p > '9')
+    return nullptr;
+  // Values that would overflow are malformed rather than wrapped.
+  constexpr long long kLimit = (std::numeric_limits<long long>::max() - 9) / 10;
+  long long value = 0;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p)
+  {
+    if (value > kLimit)
+      return nullptr;
+    value = value * 10 + (*p - '0');
+  }
+  out = negative ? -value : value;
+  return p;
+}
+
+void setError(QString* errorText, const QString& message)
+{
+  if (errorText)
+    *errorText = message;
+}
+
+struct ObjChunk
+{
+  std::vector<gp_Pnt> vertices;
+  std::vector<int> indices;
+  // Negative (relative) references are resolved once the vertex offset of the chunk is known.
+  std::vector<std::pair<size_t, long long>> relativeRefs;
+  bool malformed = false;
+};
+
+void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+  std::vector<long long> polygon;
+  while (p < end)
+  {
+    const char* eol = lineEnd(p, end);
+    const char* s = skipBlanks(p, eol);
+    if (eol - s >= 2 && isBlank(s[1]))
+    {
+      if (s[0] == 'v')
+      {
+        double c[3] = {0.0, 0.0, 0.0};
+        const char* q = s + 1;
+        for (int a = 0; a < 3 && q; ++a)
+          q = parseDouble(q, eol, c[a]);
+        if (!q)
+          chunk.malformed = true;
+        chunk.vertices.emplace_back(c[0], c[1], c[2]);
+      }
+      else if (s[0] == 'f')
+      {
+        polygon.clear();
+        const char* q = s + 1;
+        for (;;)
+        {
+          q = skipBlanks(q, eol);
+          if (q >= eol)
+            break;
+          long long ref = 0;
+          const char* next = parseInt(q, eol, ref);
+          // Indices are stored as int; relative ones may still reach into earlier chunks and are range-checked
+          // once the chunk offsets are known.
+          if (!next || ref == 0 || ref > std::numeric_limits<int>::max() || ref < -std::numeric_limits<int>::max())
+          {
+            chunk.malformed = true;
+            break;
+          }
+          polygon.push_back(ref);
+          q = next;
+          while (q < eol && !isBlank(*q))
+            ++q;
+        }
+
+        const long long localCount = static_cast<long long>(chunk.vertices.size());
+        for (size_t k = 2; k < polygon.size(); ++k)
+        {
+          const long long refs[3] = {polygon[0], polygon[k - 1], polygon[k]};
+          for (const long long ref : refs)
+          {
+            if (ref > 0)
+            {
+              chunk.indices.push_back(static_cast<int>(ref - 1));
+            }
+            else
+            {
+              chunk.relativeRefs.emplace_back(chunk.indices.size(), localCount + ref);
+              chunk.indices.push_back(0);
+            }
+          }
+        }
+      }
+    }
+    p = eol + 1;
+  }
+}
+
+bool readObj(const char* data, size_t size, TriMesh& mesh, QString* errorText)
+{
+  const size_t chunkCount = std::max<size_t>(1, std::min(parallelWorkerCount() * 4, size / kMinObjChunkBytes));
+  std::vector<const char*> bounds(chunkCount + 1);
+  bounds[0] = data;
+  bounds[chunkCount] = data + size;
+  for (size_t i = 1; i < chunkCount; ++i)
+  {
+    const char* guess = std::max(bounds[i - 1], data + size / chunkCount * i);
+    bounds[i] = std::min(lineEnd(guess, data + size) + 1, data + size);
+  }
+
+  std::vector<ObjChunk> chunks(chunkCount);
+  parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      parseObjChunk(bounds[i], bounds[i + 1], chunks[i]);
+  });
+
+  std::vector<size_t> vertexOffsets(chunkCount + 1, 0);
+  std::vector<size_t> indexOffsets(chunkCount + 1, 0);
+  for (size_t i = 0; i < chunkCount; ++i)
+  {
+    if (chunks[i].malformed)
+    {
+      setError(errorText, QStringLiteral("OBJ格式错误"));
+      return false;
+    }
+    vertexOffsets[i + 1] = vertexOffsets[i] + chunks[i].vertices.size();
+    indexOffsets[i + 1] = indexOffsets[i] + chunks[i].indices.size();
+  }
+
+  const size_t vertexCount = vertexOffsets[chunkCount];
+  mesh.vertices.resize(vertexCount);
+  mesh.indices.resize(indexOffsets[chunkCount]);
+
+  std::vector<char> badIndex(chunkCount, 0);
+  parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      ObjChunk& chunk = chunks[i];
+      for (const auto& rel : chunk.relativeRefs)
+      {
+        const long long idx = static_cast<long long>(vertexOffsets[i]) + rel.second;
+        if (idx < 0 || static_cast<size_t>(idx) >= vertexCount)
+          badIndex[i] = 1;
+        else
+          chunk.indices[rel.first] = static_cast<int>(idx);
+      }
+      for (const int idx : chunk.indices)
+      {
+        if (idx < 0 || static_cast<size_t>(idx) >= vertexCount)
+          badIndex[i] = 1;
+      }
+      std::copy(chunk.vertices.begin(), chunk.vertices.end(), mesh.vertices.begin() + vertexOffsets[i]);
+      std::copy(chunk.indices.begin(), chunk.indices.end(), mesh.indices.begin() + indexOffsets[i]);
+      std::vector<gp_Pnt>().swap(chunk.vertices);
+      std::vector<int>().swap(chunk.indices);
+    }
+  });
+
+  if (std::find(badIndex.begin(), badIndex.end(), 1) != badIndex.end())
+  {
+    setError(errorText, QStringLiteral("OBJ面索引越界"));
+    return false;
+  }
+  return true;
+}
+
+// STL stores every triangle with its own three corners; identical corners are merged so the
+// result is a connected TriMesh like the one built from IGES.
+class SoupWelder
+{
+public:
+  explicit SoupWelder(TriMesh& mesh, size_t triCount)
+    : m_mesh(mesh)
+  {
+    m_map.reserve(triCount);
+    m_mesh.vertices.reserve(triCount / 2 + 3);
+    m_mesh.indices.reserve(triCount * 3);
+  }
+
+  void add(double x, double y, double z)
+  {
+    const Key key{x, y, z};
+    auto it = m_map.find(key);
+    if (it == m_map.end())
+    {
+      const int id = static_cast<int>(m_mesh.vertices.size());
+      m_mesh.vertices.emplace_back(x, y, z);
+      m_map.emplace(key, id);
+      m_mesh.indices.push_back(id);
+    }
+    else
+    {
+      m_mesh.indices.push_back(it->second);
+    }
+  }
+
+private:
+  struct Key
+  {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    bool operator==(const Key& o) const { return x == o.x && y == o.y && z == o.z; }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& k) const noexcept
+    {
+      const std::hash<double> h;
+      return h(k.x) * 73856093ULL ^ h(k.y) * 19349663ULL ^ h(k.z) * 83492791ULL;
+    }
+  };
+
+  TriMesh& m_mesh;
+  std::unordered_map<Key, int, KeyHash> m_map;
+};
+
+template <typename T>
+T readLittleEndian(const char* p)
+{
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+  char* b = reinterpret_cast<char*>(&value);
+  std::reverse(b, b + sizeof(T));
+#endif
+  return value;
+}
+
+bool readStl(const char* data, size_t size, TriMesh& mesh, QString* errorText)
+{
+  if (size >= 84)
+  {
+    const uint32_t triCount = readLittleEndian<uint32_t>(data + 80);
+    if (84 + static_cast<uint64_t>(triCount) * 50 == size)
+    {
+      SoupWelder welder(mesh, triCount);
+      for (uint32_t t = 0; t < triCount; ++t)
+      {
+        const char* rec = data + 84 + static_cast<size_t>(t) * 50 + 12;
+        for (int k = 0; k < 3; ++k)
+        {
+          welder.add(readLittleEndian<float>(rec + k * 12 + 0), readLittleEndian<float>(rec + k * 12 + 4),
+                     readLittleEndian<float>(rec + k * 12 + 8));
+        }
+      }
+      return true;
+    }
+  }
+
+  const char* end = data + size;
+  const char* p = skipBlanks(data, end);
+  if (end - p < 5 || std::memcmp(p, "solid", 5) != 0)
+  {
+    setError(errorText, QStringLiteral("无法识别的STL文件"));
+    return false;
+  }
+
+  SoupWelder welder(mesh, size / 256);
+  size_t corners = 0;
+  while (p < end)
+  {
+    const char* eol = lineEnd(p, end);
+    const char* s = skipBlanks(p, eol);
+    if (eol - s > 6 && std::memcmp(s, "vertex", 6) == 0 && isBlank(s[6]))
+    {
+      double c[3] = {0.0, 0.0, 0.0};
+      const char* q = s + 6;
+      for (int a = 0; a < 3 && q; ++a)
+        q = parseDouble(q, eol, c[a]);
+      if (!q)
+      {
+        setError(errorText, QStringLiteral("STL格式错误"));
+        return false;
+      }
+      welder.add(c[0], c[1], c[2]);
+      ++corners;
+    }
+    p = eol + 1;
+  }
+
+  if (corners % 3 != 0)
+  {
+    setError(errorText, QStringLiteral("STL格式错误"));
+    return false;
+  }
+  return true;
+}
+
+enum class PlyType
+{
+  Int8,
+  UInt8,
+  Int16,
+  UInt16,
+  Int32,
+  UInt32,
+  Float32,
+  Float64,
+  Invalid
+};
+
+PlyType plyTypeOf(const QByteArray& name)
+{
+  if (name == "char" || name == "int8")
+    return PlyType::Int8;
+  if (name == "uchar" || name == "uint8")
+    return PlyType::UInt8;
+  if (name == "short" || name == "int16")
+    return PlyType::Int16;
+  if (name == "ushort" || name == "uint16")
+    return PlyType::UInt16;
+  if (name == "int" || name == "int32")
+    return PlyType::Int32;
+  if (name == "uint" || name == "uint32")
+    return PlyType::UInt32;
+  if (name == "float" || name == "float32")
+    return PlyType::Float32;
+  if (name == "double" || name == "float64")
+    return PlyType::Float64;
+  return PlyType::Invalid;
+}
+
+size_t plyTypeSize(PlyType type)
+{
+  switch (type)
+  {
+    case PlyType::Int8:
+    case PlyType::UInt8:
+      return 1;
+    case PlyType::Int16:
+    case PlyType::UInt16:
+      return 2;
+    case PlyType::Int32:
+    case PlyType::UInt32:
+    case PlyType::Float32:
+      return 4;
+    case PlyType::Float64:
+      return 8;
+    case PlyType::Invalid:
+      break;
+  }
+  return 0;
+}
+
+struct PlyProperty
+{
+  QByteArray name;
+  PlyType type = PlyType::Invalid;
+  PlyType countType = PlyType::Invalid;
+  bool isList = false;
+};
+
+struct PlyElement
+{
+  QByteArray name;
+  size_t count = 0;
+  std::vector<PlyProperty> properties;
+};
+
+class PlyCursor
+{
+public:
+  PlyCursor(const char* p, const char* end, bool ascii, bool bigEndian)
+    : m_p(p)
+    , m_end(end)
+    , m_ascii(ascii)
+    , m_bigEndian(bigEndian)
+  {
+  }
+
+  bool read(PlyType type, double& out)
+  {
+    if (m_ascii)
+    {
+      while (m_p < m_end && (isBlank(*m_p) || *m_p == '\n'))
+        ++m_p;
+      const char* next = parseDouble(m_p, m_end, out);
+      if (!next)
+        return false;
+      m_p = next;
+      return true;
+    }
+
+    const size_t n = plyTypeSize(type);
+    if (n == 0 || static_cast<size_t>(m_end - m_p) < n)
+      return false;
+    char bytes[8];
+    std::memcpy(bytes, m_p, n);
+    m_p += n;
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    const bool swap = !m_bigEndian;
+#else
+    const bool swap = m_bigEndian;
+#endif
+    if (swap)
+      std::reverse(bytes, bytes + n);
+
+    switch (type)
+    {
+      case PlyType::Int8: out = static_cast<int8_t>(bytes[0]); break;
+      case PlyType::UInt8: out = static_cast<uint8_t>(bytes[0]); break;
+      case PlyType::Int16: out = fromBytes<int16_t>(bytes); break;
+      case PlyType::UInt16: out = fromBytes<uint16_t>(bytes); break;
+      case PlyType::Int32: out = fromBytes<int32_t>(bytes); break;
+      case PlyType::UInt32: out = fromBytes<uint32_t>(bytes); break;
+      case PlyType::Float32: out = fromBytes<float>(bytes); break;
+      case PlyType::Float64: out = fromBytes<double>(bytes); break;
+      case PlyType::Invalid: return false;
+    }
+    return true;
+  }
+
+  size_t remaining() const { return static_cast<size_t>(m_end - m_p); }
+
+  // Lower bound on the bytes one value of the given type occupies; ASCII values need a digit.
+  size_t minValueBytes(PlyType type) const { return m_ascii ? 1 : plyTypeSize(type); }
+
+private:
+  template <typename T>
+  static T fromBytes(const char* bytes)
+  {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+  }
+
+  const char* m_p;
+  const char* m_end;
+  bool m_ascii;
+  bool m_bigEndian;
+};
+
+bool readPly(const char* data, size_t size, TriMesh& mesh, QString* errorText)
+{
+  const char* end = data + size;
+  const char* p = data;
+  bool ascii = false;
+  bool bigEndian = false;
+  bool haveFormat = false;
+  std::vector<PlyElement> elements;
+
+  for (bool first = true;; first = false)
+  {
+    if (p >= end)
+    {
+      setError(errorText, QStringLiteral("PLY文件头不完整"));
+      return false;
+    }
+    const char* eol = lineEnd(p, end);
+    const QList<QByteArray> tokens = QByteArray(p, static_cast<int>(eol - p)).simplified().split(' ');
+    p = eol + 1;
+
+    if (first)
+    {
+      if (tokens.value(0) != "ply")
+      {
+        setError(errorText, QStringLiteral("无法识别的PLY文件"));
+        return false;
+      }
+      continue;
+    }
+
+    const QByteArray keyword = tokens.value(0);
+    if (keyword == "end_header")
+      break;
+    if (keyword == "format")
+    {
+      const QByteArray format = tokens.value(1);
+      ascii = format == "ascii";
+      bigEndian = format == "binary_big_endian";
+      haveFormat = ascii || bigEndian || format == "binary_little_endian";
+    }
+    else if (keyword == "element")
+    {
+      PlyElement element;
+      element.name = tokens.value(1);
+      element.count = tokens.value(2).toULongLong();
+      elements.push_back(element);
+    }
+    else if (keyword == "property" && !elements.empty())
+    {
+      PlyProperty prop;
+      if (tokens.value(1) == "list")
+      {
+        prop.isList = true;
+        prop.countType = plyTypeOf(tokens.value(2));
+        prop.type = plyTypeOf(tokens.value(3));
+        prop.name = tokens.value(4);
+      }
+      else
+      {
+        prop.type = plyTypeOf(tokens.value(1));
+        prop.name = tokens.value(2);
+      }
+      elements.back().properties.push_back(prop);
+    }
+  }
+
+  if (!haveFormat)
+  {
+    setError(errorText, QStringLiteral("不支持的PLY格式"));
+    return false;
+  }
+
+  PlyCursor cursor(p, end, ascii, bigEndian);
+  size_t vertexCount = 0;
+  for (const PlyElement& element : elements)
+  {
+    // Elements without properties are skipped below, so they add no vertices.
+    if (element.name == "vertex" && !element.properties.empty())
+      vertexCount = element.count;
+  }
+
+  for (const PlyElement& element : elements)
+  {
+    const bool isVertex = element.name == "vertex";
+    const bool isFace = element.name == "face";
+    if (element.properties.empty())
+      continue;
+
+    // Reject counts the remaining data cannot hold before they size any allocation.
+    size_t minElementBytes = 0;
+    for (const PlyProperty& prop : element.properties)
+      minElementBytes += cursor.minValueBytes(prop.isList ? prop.countType : prop.type);
+    if (minElementBytes == 0 || element.count > cursor.remaining() / minElementBytes + 1)
+    {
+      setError(errorText, QStringLiteral("PLY数据不完整"));
+      return false;
+    }
+    if (isVertex)
+      mesh.vertices.reserve(element.count);
+
+    std::vector<double> polygon;
+    for (size_t e = 0; e < element.count; ++e)
+    {
+      double xyz[3] = {0.0, 0.0, 0.0};
+      for (const PlyProperty& prop : element.properties)
+      {
+        double value = 0.0;
+        if (!prop.isList)
+        {
+          if (!cursor.read(prop.type, value))
+          {
+            setError(errorText, QStringLiteral("PLY数据不完整"));
+            return false;
+          }
+          if (isVertex && prop.name.size() == 1 && prop.name[0] >= 'x' && prop.name[0] <= 'z')
+            xyz[prop.name[0] - 'x'] = value;
+          continue;
+        }
+
+        double count = 0.0;
+        const size_t minValueBytes = cursor.minValueBytes(prop.type);
+        if (!cursor.read(prop.countType, count) || !(count >= 0.0) || minValueBytes == 0
+            || count > static_cast<double>(cursor.remaining() / minValueBytes))
+        {
+          setError(errorText, QStringLiteral("PLY数据不完整"));
+          return false;
+        }
+        polygon.resize(static_cast<size_t>(count));
+        for (double& v : polygon)
+        {
+          if (!cursor.read(prop.type, v))
+          {
+            setError(errorText, QStringLiteral("PLY数据不完整"));
+            return false;
+          }
+        }
+        if (isFace && (prop.name == "vertex_indices" || prop.name == "vertex_index"))
+        {
+          for (const double v : polygon)
+          {
+            if (!(v >= 0.0 && v < static_cast<double>(vertexCount)
+                  && v <= static_cast<double>(std::numeric_limits<int>::max())))
+            {
+              setError(errorText, QStringLiteral("PLY面索引越界"));
+              return false;
+            }
+          }
+          for (size_t k = 2; k < polygon.size(); ++k)
+          {
+            mesh.indices.push_back(static_cast<int>(polygon[0]));
+            mesh.indices.push_back(static_cast<int>(polygon[k - 1]));
+            mesh.indices.push_back(static_cast<int>(polygon[k]));
+          }
+        }
+      }
+      if (isVertex)
+        mesh.vertices.emplace_back(xyz[0], xyz[1], xyz[2]);
+    }
+  }
+  return true;
+}
+} // namespace
+
+bool MeshReader::readFile(const QString& filePath, TriMesh& mesh, QString* errorText)
+{
+  mesh.vertices.clear();
+  mesh.indices.clear();
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    setError(errorText, QStringLiteral("无法读取文件：%1").arg(filePath));
+    return false;
+  }
+
+  const qint64 size = file.size();
+  const uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+  if (!mapped)
+  {
+    setError(errorText, QStringLiteral("无法读取文件：%1").arg(filePath));
+    return false;
+  }
+
+  const char* data = reinterpret_cast<const char*>(mapped);
+  const QString suffix = QFileInfo(filePath).suffix().toLower();
+  bool ok = false;
+  if (suffix == QStringLiteral("obj"))
+    ok = readObj(data, static_cast<size_t>(size), mesh, errorText);
+  else if (suffix == QStringLiteral("stl"))
+    ok = readStl(data, static_cast<size_t>(size), mesh, errorText);
+  else if (suffix == QStringLiteral("ply"))
+    ok = readPly(data, static_cast<size_t>(size), mesh, errorText);
+  else if (suffix == QStringLiteral("imz"))
+    ok = MeshCodec::decode(data, static_cast<size_t>(size), mesh, errorText);
+  else
+    setError(errorText, QStringLiteral("不支持的网格格式：%1").arg(suffix));
+
+  file.unmap(const_cast<uchar*>(mapped));
+
+  if (ok && mesh.indices.empty())
+  {
+    setError(errorText, QStringLiteral("网格文件中没有三角面"));
+    ok = false;
+  }
+  if (!ok)
+  {
+    mesh.vertices.clear();
+    mesh.indices.clear();
+  }
+  return ok;
+}
@@ -1,28 +1,24 @@
 #include "Occt/OcctViewerWidget.h"
 
 #include <cmath>
-#include <unordered_map>
 
 #include <QMouseEvent>
 #include <QWheelEvent>
 
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_Shape.hxx>
+#include <AIS_Triangulation.hxx>
 #include <Aspect_DisplayConnection.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
-#include <BRep_Tool.hxx>
+#include <BRep_Builder.hxx>
 #include <Graphic3d_Camera.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
 #include <Graphic3d_RenderingParams.hxx>
-#include <IGESControl_Reader.hxx>
 #include <OpenGl_GraphicDriver.hxx>
 #include <Poly_Triangulation.hxx>
+#include <Prs3d_Drawer.hxx>
 #include <Quantity_Color.hxx>
-#include <TopoDS.hxx>
-#include <TopoDS_Face.hxx>
-#include <TopExp_Explorer.hxx>
-#include <TopLoc_Location.hxx>
-#include <TopAbs_Orientation.hxx>
+#include <TopoDS_Compound.hxx>
 #include <V3d_View.hxx>
 #include <V3d_Viewer.hxx>
 
@@ -30,28 +26,32 @@
   #include <WNT_Window.hxx>
 #endif
 
+#include "Occt/FunctionJob.h"
+#include "Occt/MeshBuilder.h"
+#include "Occt/MeshBvh.h"
+#include "Occt/MeshCodec.h"
+#include "Occt/MeshReader.h"
 #include "Occt/MeshTypes.h"
 #include "Occt/ObjExporter.h"
+#include "Occt/ParallelFor.h"
 
-static gp_Pnt transformedNode(const Handle(Poly_Triangulation)& tri, int nodeIndex1, const gp_Trsf& trsf)
+static void meshForDisplay(const TopoDS_Shape& shape, const MeshingParams& params)
 {
-  gp_Pnt p = tri->Node(nodeIndex1);
-  p.Transform(trsf);
-  return p;
+  BRepMesh_IncrementalMesh mesher(shape, params.linearDeflection, false, params.angularDeflection, true);
+  mesher.Perform();
 }
 
-static bool isCoplanar(const gp_Pnt& a, const gp_Pnt& b, const gp_Pnt& c, const gp_Pnt& d)
+// limitBytes > 0 skips meshes whose BVH could not fit; the caller still checks the shared budget.
+static std::shared_ptr<const MeshBvh> buildPickBvh(const TriMesh& mesh, qint64 limitBytes)
 {
-  const gp_Vec ab(a, b);
-  const gp_Vec ac(a, c);
-  const gp_Vec n = ab.Crossed(ac);
-  const double n2 = n.SquareMagnitude();
-  if (n2 < 1e-18)
-    return false;
-
-  const gp_Vec ad(a, d);
-  const double dist = std::abs(ad.Dot(n)) / std::sqrt(n2);
-  return dist < 1e-6;
+  // Packed triangle, index and about one node per triangle.
+  const qint64 estimate = static_cast<qint64>(mesh.indices.size() / 3) * 80;
+  if (mesh.indices.empty() || (limitBytes > 0 && estimate > limitBytes))
+    return nullptr;
+
+  auto bvh = std::make_shared<MeshBvh>();
+  bvh->build(mesh);
+  return bvh;
 }
 
 OcctViewerWidget::OcctViewerWidget(QWidget* parent)
@@ -68,6 +68,8 @@ OcctViewerWidget::OcctViewerWidget(QWidget* parent)
 
 OcctViewerWidget::~OcctViewerWidget()
 {
+  m_loadPool.clear();
+  m_loadPool.waitForDone();
   m_view.Nullify();
   m_context.Nullify();
   m_viewer.Nullify();
@@ -147,6 +149,7 @@ void OcctViewerWidget::fitAll()
 void OcctViewerWidget::mousePressEvent(QMouseEvent* event)
 {
   m_lastMousePos = event->pos();
+  m_pressPos = event->pos();
   if (event->button() == Qt::LeftButton)
   {
     m_isMouseRotating = true;
@@ -179,12 +182,44 @@ void OcctViewerWidget::mouseMoveEvent(QMouseEvent* event)
     redraw();
     return;
   }
+
+  updateHoverPick(cur);
+}
+
+void OcctViewerWidget::updateHoverPick(const QPoint& pos)
+{
+  if (m_pickBvhs.empty())
+    return;
+
+  double x = 0.0, y = 0.0, z = 0.0;
+  double vx = 0.0, vy = 0.0, vz = 0.0;
+  m_view->ConvertWithProj(pos.x(), pos.y(), x, y, z, vx, vy, vz);
+  if (vx * vx + vy * vy + vz * vz < 1e-24)
+    return;
+
+  const MeshRay ray{gp_Pnt(x, y, z), gp_Dir(vx, vy, vz)};
+  MeshQueryHit hit;
+  for (const std::shared_ptr<const MeshBvh>& bvh : m_pickBvhs)
+  {
+    const MeshQueryHit partHit = hit.isValid() ? bvh->rayCast(ray, hit.distance) : bvh->rayCast(ray);
+    if (partHit.isValid())
+      hit = partHit;
+  }
+  if (!hit.isValid() && !m_hoverHasHit)
+    return;
+
+  m_hoverHasHit = hit.isValid();
+  emit hoverPointChanged(hit.isValid(), hit.point.X(), hit.point.Y(), hit.point.Z());
 }
 
 void OcctViewerWidget::mouseReleaseEvent(QMouseEvent* event)
 {
   if (event->button() == Qt::LeftButton)
+  {
     m_isMouseRotating = false;
+    if ((event->pos() - m_pressPos).manhattanLength() <= 2)
+      selectAt(event->pos());
+  }
   if (event->button() == Qt::MiddleButton)
     m_isMousePanning = false;
 }
@@ -211,282 +246,292 @@ void OcctViewerWidget::wheelEvent(QWheelEvent* event)
   redraw();
 }
 
-QPaintEngine* OcctViewerWidget::paintEngine() const
+void OcctViewerWidget::selectAt(const QPoint& pos)
 {
-  return nullptr;
+  if (m_context.IsNull() || m_view.IsNull() || m_parts.empty())
+    return;
+
+  m_context->MoveTo(pos.x(), pos.y(), m_view, false);
+  m_context->SelectDetected();
+  redraw();
+
+  const int index = selectedPartIndex();
+  emit selectionChanged(index >= 0 ? m_parts[index].filePath : QString());
 }
 
-bool OcctViewerWidget::loadIgsFile(const QString& filePath, QString* errorText)
+int OcctViewerWidget::selectedPartIndex() const
 {
-  IGESControl_Reader reader;
-  const IFSelect_ReturnStatus status = reader.ReadFile(filePath.toUtf8().constData());
-  if (status != IFSelect_RetDone)
+  if (m_context.IsNull())
+    return -1;
+  for (size_t i = 0; i < m_parts.size(); ++i)
   {
-    if (errorText)
-      *errorText = QStringLiteral("IGES读取失败：%1").arg(filePath);
-    return false;
+    if (m_context->IsSelected(m_parts[i].presentation))
+      return static_cast<int>(i);
   }
-
-  reader.TransferRoots();
-  TopoDS_Shape shape = reader.OneShape();
-  if (shape.IsNull())
-  {
-    if (errorText)
-      *errorText = QStringLiteral("IGES文件未生成有效Shape");
-    return false;
-  }
-
-  m_shape = shape;
-  m_triMesh.reset();
-  m_quadMesh.reset();
-
-  if (!m_context.IsNull())
-    m_context->RemoveAll(false);
-  displayShape();
-  fitAll();
-  redraw();
-  return true;
+  return -1;
 }
 
-void OcctViewerWidget::displayShape()
+QPaintEngine* OcctViewerWidget::paintEngine() const
 {
-  if (m_shape.IsNull() || m_context.IsNull())
-    return;
-  Handle(AIS_Shape) prs = new AIS_Shape(m_shape);
-  m_context->Display(prs, false);
-  m_context->SetDisplayMode(prs, AIS_Shaded, false);
-  fitAll();
+  return nullptr;
 }
 
-static std::shared_ptr<TriMesh> buildGlobalTriMesh(const TopoDS_Shape& shape)
+void OcctViewerWidget::loadIgsFiles(const QStringList& filePaths)
 {
-  BRepMesh_IncrementalMesh mesher(shape, 0.5, false, 0.5, true);
-  mesher.Perform();
-
-  auto mesh = std::make_shared<TriMesh>();
-  struct Key
-  {
-    long long x = 0;
-    long long y = 0;
-    long long z = 0;
-    bool operator==(const Key& o) const { return x == o.x && y == o.y && z == o.z; }
-  };
-
-  struct KeyHash
-  {
-    size_t operator()(const Key& k) const noexcept
-    {
-      const size_t hx = static_cast<size_t>(k.x) * 73856093ULL;
-      const size_t hy = static_cast<size_t>(k.y) * 19349663ULL;
-      const size_t hz = static_cast<size_t>(k.z) * 83492791ULL;
-      return hx ^ hy ^ hz;
-    }
-  };
+  resetModelData();
+  if (filePaths.isEmpty())
+    return;
 
-  std::unordered_map<Key, int, KeyHash> vertexMap;
-  vertexMap.reserve(200000);
+  // The IGES controller registers global state; do that once before readers run on several threads.
+  MeshBuilder::warmUp();
 
-  const double scale = 1000000.0;
-  auto keyOf = [&](const gp_Pnt& p) -> Key {
-    return Key{
-      static_cast<long long>(std::llround(p.X() * scale)),
-      static_cast<long long>(std::llround(p.Y() * scale)),
-      static_cast<long long>(std::llround(p.Z() * scale)),
-    };
-  };
+  const int generation = m_loadGeneration;
+  const bool healing = m_healingEnabled;
+  const MeshingParams params = m_meshingParams;
+  const qint64 pickLimit = m_memoryBudget.limitBytes();
+  m_pendingLoads = static_cast<int>(filePaths.size());
+  m_loadTimer.start();
 
-  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+  for (const QString& filePath : filePaths)
   {
-    const TopoDS_Face face = TopoDS::Face(exp.Current());
-    TopLoc_Location loc;
-    const Handle(Poly_Triangulation) tri = BRep_Tool::Triangulation(face, loc);
-    if (tri.IsNull())
-      continue;
-
-    const gp_Trsf trsf = loc.Transformation();
-    const int nbTriangles = tri->NbTriangles();
-    for (int i = 1; i <= nbTriangles; ++i)
-    {
-      int n1 = 0, n2 = 0, n3 = 0;
-      tri->Triangle(i).Get(n1, n2, n3);
-      if (face.Orientation() == TopAbs_REVERSED)
-        std::swap(n2, n3);
-
-      const gp_Pnt p1 = transformedNode(tri, n1, trsf);
-      const gp_Pnt p2 = transformedNode(tri, n2, trsf);
-      const gp_Pnt p3 = transformedNode(tri, n3, trsf);
-
-      const gp_Pnt pts[3] = {p1, p2, p3};
-      int ids[3] = {-1, -1, -1};
-
-      for (int k = 0; k < 3; ++k)
+    m_loadPool.start(new FunctionJob([this, generation, healing, params, pickLimit, filePath]() {
+      TopoDS_Shape shape;
+      HealingReport report;
+      QString errorText;
+      const bool ok = healing ? ShapeHealer::readHealedIgsFile(filePath, ShapeHealer::kDefaultTolerance, shape,
+                                                               &report, &errorText)
+                              : MeshBuilder::readIgsFile(filePath, shape, &errorText);
+      // Mesh and build the hover BVH here so the GUI thread only has to build the presentation. The BVH
+      // needs no welded vertices, so it is built straight from the face triangulations.
+      std::shared_ptr<const MeshBvh> pickBvh;
+      if (ok)
       {
-        const Key key = keyOf(pts[k]);
-        auto it = vertexMap.find(key);
-        if (it == vertexMap.end())
-        {
-          const int newId = static_cast<int>(mesh->vertices.size());
-          mesh->vertices.push_back(pts[k]);
-          vertexMap.emplace(key, newId);
-          ids[k] = newId;
-        }
-        else
-        {
-          ids[k] = it->second;
-        }
+        meshForDisplay(shape, params);
+        pickBvh = buildPickBvh(*MeshBuilder::collectTriangles(shape), pickLimit);
       }
 
-      mesh->indices.push_back(ids[0]);
-      mesh->indices.push_back(ids[1]);
-      mesh->indices.push_back(ids[2]);
-    }
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, filePath, ok, shape, params, pickBvh, report, errorText]() {
+          finishPartLoad(generation, filePath, ok, shape, params, pickBvh, report, errorText);
+        },
+        Qt::QueuedConnection);
+    }));
   }
-
-  return mesh;
 }
 
-static std::shared_ptr<QuadMesh> buildQuadMeshFromTriMesh(const TriMesh& triMesh)
+void OcctViewerWidget::finishPartLoad(int generation, const QString& filePath, bool ok, const TopoDS_Shape& shape,
+                                      const MeshingParams& meshedWith, const std::shared_ptr<const MeshBvh>& pickBvh,
+                                      const HealingReport& report, const QString& errorText)
 {
-  auto quad = std::make_shared<QuadMesh>();
-  quad->vertices = triMesh.vertices;
+  if (generation != m_loadGeneration)
+    return;
 
-  struct EdgeKey
+  --m_pendingLoads;
+  if (ok)
   {
-    int a = 0;
-    int b = 0;
-    bool operator==(const EdgeKey& o) const { return a == o.a && b == o.b; }
-  };
+    ++m_loadedCount;
+    m_lastHealingReport = report;
+    addScenePart(filePath, shape, meshedWith, pickBvh);
+    redraw();
+  }
+  else
+  {
+    ++m_failedCount;
+  }
+  emit partLoaded(filePath, ok, errorText);
 
-  struct EdgeHash
+  // Fitting per part would keep moving the camera while the batch streams in.
+  if (m_pendingLoads == 0)
   {
-    size_t operator()(const EdgeKey& e) const noexcept
-    {
-      return (static_cast<size_t>(e.a) << 32) ^ static_cast<size_t>(e.b);
-    }
-  };
+    fitAll();
+    redraw();
+    emit sceneLoadFinished(m_loadedCount, m_failedCount, m_loadTimer.elapsed());
+  }
+}
 
-  struct TriRef
+void OcctViewerWidget::addScenePart(const QString& filePath, const TopoDS_Shape& shape, const MeshingParams& meshedWith,
+                                    const std::shared_ptr<const MeshBvh>& pickBvh)
+{
+  // The display triangulation doubles as the first stage of the face cache.
+  if (!m_memoryBudget.isLimited())
+    m_faceCache.adoptTriangulations(shape, meshedWith);
+
+  ScenePart part;
+  part.filePath = filePath;
+  part.shape = shape;
+  part.triangulationBytes = MeshBuilder::triangulationBytes(shape);
+  if (!m_context.IsNull())
   {
-    int triIndex = 0;
-    int localEdge = 0;
-  };
+    part.presentation = new AIS_Shape(shape);
+    // Parts arrive already meshed with the export parameters; reuse that triangulation.
+    part.presentation->Attributes()->SetAutoTriangulation(false);
+    m_context->Display(part.presentation, AIS_Shaded, 0, false);
+  }
+  m_parts.push_back(part);
 
-  const int triCount = static_cast<int>(triMesh.indices.size() / 3);
-  std::vector<bool> used(triCount, false);
-  std::unordered_map<EdgeKey, TriRef, EdgeHash> edgeOwner;
-  edgeOwner.reserve(static_cast<size_t>(triCount) * 2);
+  BRep_Builder builder;
+  TopoDS_Compound scene;
+  builder.MakeCompound(scene);
+  for (const ScenePart& p : m_parts)
+    builder.Add(scene, p.shape);
+  m_shape = m_parts.size() == 1 ? shape : TopoDS_Shape(scene);
 
-  auto edgeKey = [](int u, int v) -> EdgeKey {
-    if (u < v)
-      return {u, v};
-    return {v, u};
-  };
+  // Scene-wide meshes are rebuilt lazily from the new compound.
+  m_triMesh.reset();
+  m_quadMesh.reset();
+  m_memoryBudget.clear();
+  m_memoryBudget.record(MemoryBudget::kStageFaceTriangulations, displayTriangulationBytes());
+  if (!m_pickBvhs.empty())
+    m_memoryBudget.record(MemoryBudget::kStagePickBvh, pickMemoryBytes());
+  addPickAccelerator(pickBvh);
+}
 
-  auto triVertex = [&](int t, int i) -> int { return triMesh.indices[static_cast<size_t>(t) * 3 + i]; };
+void OcctViewerWidget::addPickAccelerator(const std::shared_ptr<const MeshBvh>& bvh)
+{
+  if (!bvh)
+    return;
+  const qint64 bytes = static_cast<qint64>(bvh->memoryBytes());
+  if (!m_memoryBudget.check(MemoryBudget::kStagePickBvh, bytes, nullptr))
+    return;
+  m_pickBvhs.push_back(bvh);
+  m_memoryBudget.record(MemoryBudget::kStagePickBvh, pickMemoryBytes());
+}
 
-  struct QuadCandidate
-  {
-    int t0 = -1;
-    int t1 = -1;
-    int sharedA = -1;
-    int sharedB = -1;
-    int other0 = -1;
-    int other1 = -1;
-  };
-
-  std::vector<QuadCandidate> candidates;
-  candidates.reserve(triCount / 2);
-
-  for (int t = 0; t < triCount; ++t)
-  {
-    const int v0 = triVertex(t, 0);
-    const int v1 = triVertex(t, 1);
-    const int v2 = triVertex(t, 2);
+qint64 OcctViewerWidget::pickMemoryBytes() const
+{
+  qint64 bytes = 0;
+  for (const std::shared_ptr<const MeshBvh>& bvh : m_pickBvhs)
+    bytes += static_cast<qint64>(bvh->memoryBytes());
+  return bytes;
+}
 
-    const int ev[3][2] = {{v0, v1}, {v1, v2}, {v2, v0}};
-    for (int e = 0; e < 3; ++e)
-    {
-      const EdgeKey k = edgeKey(ev[e][0], ev[e][1]);
-      auto it = edgeOwner.find(k);
-      if (it == edgeOwner.end())
-      {
-        edgeOwner.emplace(k, TriRef{t, e});
-      }
-      else
-      {
-        const int t2 = it->second.triIndex;
-        if (t2 == t)
-          continue;
+qint64 OcctViewerWidget::displayTriangulationBytes() const
+{
+  // The shaded presentations are built from these triangulations with auto-triangulation off, so they
+  // live as long as the parts do.
+  qint64 bytes = 0;
+  for (const ScenePart& part : m_parts)
+    bytes += part.triangulationBytes;
+  return bytes;
+}
 
-        const int a = k.a;
-        const int b = k.b;
+void OcctViewerWidget::setMeshingParams(const MeshingParams& params)
+{
+  if (params == m_meshingParams)
+    return;
+  m_meshingParams = params;
 
-        const int tv0 = triVertex(t, 0);
-        const int tv1 = triVertex(t, 1);
-        const int tv2 = triVertex(t, 2);
-        const int ov_t = (tv0 != a && tv0 != b) ? tv0 : (tv1 != a && tv1 != b) ? tv1 : tv2;
+  // Meshes read from files do not depend on the meshing parameters.
+  if (m_shape.IsNull())
+    return;
+  m_triMesh.reset();
+  m_quadMesh.reset();
+  m_memoryBudget.release(MemoryBudget::kStageTriMesh);
+  m_memoryBudget.release(MemoryBudget::kStageQuadMesh);
+}
 
-        const int uv0 = triVertex(t2, 0);
-        const int uv1 = triVertex(t2, 1);
-        const int uv2 = triVertex(t2, 2);
-        const int ov_t2 = (uv0 != a && uv0 != b) ? uv0 : (uv1 != a && uv1 != b) ? uv1 : uv2;
+void OcctViewerWidget::setMemoryBudget(qint64 limitBytes)
+{
+  m_memoryBudget = MemoryBudget(qMax<qint64>(0, limitBytes));
+  if (m_memoryBudget.isLimited())
+    m_faceCache.clear();
+  else
+    m_memoryBudget.record(MemoryBudget::kStageFaceCache, m_faceCache.memoryBytes());
+  if (!m_parts.empty())
+    m_memoryBudget.record(MemoryBudget::kStageFaceTriangulations, displayTriangulationBytes());
+  if (m_triMesh)
+    m_memoryBudget.record(MemoryBudget::kStageTriMesh, MemoryBudget::bytesOf(*m_triMesh));
+  if (m_quadMesh)
+    m_memoryBudget.record(MemoryBudget::kStageQuadMesh, MemoryBudget::bytesOf(*m_quadMesh));
+  if (!m_pickBvhs.empty())
+    m_memoryBudget.record(MemoryBudget::kStagePickBvh, pickMemoryBytes());
+}
 
-        candidates.push_back(QuadCandidate{t2, t, a, b, ov_t2, ov_t});
-      }
-    }
-  }
+void OcctViewerWidget::resetModelData()
+{
+  m_loadPool.clear();
+  ++m_loadGeneration;
+  m_pendingLoads = 0;
+  m_loadedCount = 0;
+  m_failedCount = 0;
 
-  auto angleOk = [&](int sharedA, int sharedB, int other0, int other1) -> bool {
-    const gp_Pnt& A = quad->vertices[sharedA];
-    const gp_Pnt& B = quad->vertices[sharedB];
-    const gp_Pnt& C = quad->vertices[other0];
-    const gp_Pnt& D = quad->vertices[other1];
-    if (!isCoplanar(A, B, C, D))
-      return false;
+  if (!m_context.IsNull())
+    m_context->RemoveAll(false);
+  m_parts.clear();
+  m_faceCache.clear();
+  m_lastMeshStats = FaceMeshStats();
+  m_shape.Nullify();
+  m_triMesh.reset();
+  m_quadMesh.reset();
+  m_pickBvhs.clear();
+  m_hoverHasHit = false;
+  m_memoryBudget.clear();
+}
 
-    const gp_Vec n1(gp_Vec(A, C).Crossed(gp_Vec(A, B)));
-    const gp_Vec n2(gp_Vec(B, A).Crossed(gp_Vec(B, D)));
-    const double n1m = n1.Magnitude();
-    const double n2m = n2.Magnitude();
-    if (n1m < 1e-12 || n2m < 1e-12)
-      return false;
-    const double cosang = std::abs(n1.Dot(n2) / (n1m * n2m));
-    return cosang > 0.99;
-  };
+bool OcctViewerWidget::loadMeshFile(const QString& filePath, QString* errorText)
+{
+  auto mesh = std::make_shared<TriMesh>();
+  if (!MeshReader::readFile(filePath, *mesh, errorText))
+    return false;
 
-  for (const auto& c : candidates)
-  {
-    if (c.t0 < 0 || c.t1 < 0)
-      continue;
-    if (used[c.t0] || used[c.t1])
-      continue;
-    if (!angleOk(c.sharedA, c.sharedB, c.other0, c.other1))
-      continue;
-
-    used[c.t0] = true;
-    used[c.t1] = true;
-
-    quad->quadIndices.push_back(c.other0);
-    quad->quadIndices.push_back(c.sharedA);
-    quad->quadIndices.push_back(c.other1);
-    quad->quadIndices.push_back(c.sharedB);
-  }
+  resetModelData();
+  m_triMesh = mesh;
+  m_memoryBudget.record(MemoryBudget::kStageTriMesh, MemoryBudget::bytesOf(*m_triMesh));
+  displayTriMesh();
+  fitAll();
+  redraw();
 
-  for (int t = 0; t < triCount; ++t)
-  {
-    if (used[t])
-      continue;
-    quad->triIndices.push_back(triVertex(t, 0));
-    quad->triIndices.push_back(triVertex(t, 1));
-    quad->triIndices.push_back(triVertex(t, 2));
-  }
+  // The file mesh is never modified after loading, so the job can read it while the GUI keeps running.
+  const int generation = m_loadGeneration;
+  const qint64 pickLimit = m_memoryBudget.limitBytes();
+  const std::shared_ptr<const TriMesh> pickMesh = m_triMesh;
+  m_loadPool.start(new FunctionJob([this, generation, pickLimit, pickMesh]() {
+    const std::shared_ptr<const MeshBvh> bvh = buildPickBvh(*pickMesh, pickLimit);
+    QMetaObject::invokeMethod(
+      this,
+      [this, generation, bvh]() {
+        if (generation == m_loadGeneration)
+          addPickAccelerator(bvh);
+      },
+      Qt::QueuedConnection);
+  }));
+  return true;
+}
 
-  return quad;
+void OcctViewerWidget::displayTriMesh()
+{
+  if (!m_triMesh || m_context.IsNull())
+    return;
+
+  const TriMesh& mesh = *m_triMesh;
+  const int nbNodes = static_cast<int>(mesh.vertices.size());
+  const int nbTriangles = static_cast<int>(mesh.indices.size() / 3);
+  Handle(Poly_Triangulation) tri = new Poly_Triangulation(nbNodes, nbTriangles, false);
+  parallelFor(static_cast<size_t>(nbNodes), 1 << 16, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      tri->SetNode(static_cast<int>(i) + 1, mesh.vertices[i]);
+  });
+  parallelFor(static_cast<size_t>(nbTriangles), 1 << 16, [&](size_t begin, size_t end) {
+    for (size_t t = begin; t < end; ++t)
+    {
+      tri->SetTriangle(static_cast<int>(t) + 1,
+                       Poly_Triangle(mesh.indices[t * 3 + 0] + 1, mesh.indices[t * 3 + 1] + 1, mesh.indices[t * 3 + 2] + 1));
+    }
+  });
+  tri->ComputeNormals();
+  m_memoryBudget.record(MemoryBudget::kStageDisplayMesh,
+                        static_cast<qint64>(nbNodes) * static_cast<qint64>(sizeof(gp_Pnt) + 3 * sizeof(float))
+                          + static_cast<qint64>(nbTriangles) * static_cast<qint64>(sizeof(Poly_Triangle)));
+
+  Handle(AIS_Triangulation) prs = new AIS_Triangulation(tri);
+  m_context->Display(prs, false);
+  fitAll();
 }
 
 bool OcctViewerWidget::buildTriangulation(bool buildQuads, QString* errorText)
 {
-  if (m_shape.IsNull())
+  if (m_shape.IsNull() && !m_triMesh)
   {
     if (errorText)
       *errorText = QStringLiteral("当前没有模型");
@@ -494,7 +539,11 @@ bool OcctViewerWidget::buildTriangulation(bool buildQuads, QString* errorText)
   }
 
   if (!m_triMesh)
-    m_triMesh = buildGlobalTriMesh(m_shape);
+  {
+    m_triMesh = meshShape(m_shape, m_memoryBudget, errorText);
+    if (!m_triMesh)
+      return false;
+  }
 
   if (m_triMesh->vertices.empty() || m_triMesh->indices.empty())
   {
@@ -504,20 +553,37 @@ bool OcctViewerWidget::buildTriangulation(bool buildQuads, QString* errorText)
   }
 
   if (buildQuads && !m_quadMesh)
-    m_quadMesh = buildQuadMeshFromTriMesh(*m_triMesh);
+  {
+    m_quadMesh = quadMeshShape(m_shape, *m_triMesh, m_memoryBudget, errorText);
+    if (!m_quadMesh)
+      return false;
+  }
 
   return true;
 }
 
 bool OcctViewerWidget::exportObjFile(const QString& filePath, bool exportQuads, QString* errorText)
 {
-  if (m_shape.IsNull())
+  if (m_shape.IsNull() && !m_triMesh)
   {
     if (errorText)
       *errorText = QStringLiteral("当前没有模型");
     return false;
   }
 
+  const int part = selectedPartIndex();
+  if (part >= 0)
+  {
+    MemoryBudget partBudget = budgetForSelectedPart();
+    const std::shared_ptr<TriMesh> mesh = buildSelectedPartMesh(part, partBudget, errorText);
+    if (!mesh)
+      return false;
+    if (!exportQuads)
+      return ObjExporter::exportTriMesh(filePath, *mesh, errorText);
+    const std::shared_ptr<QuadMesh> quad = quadMeshShape(m_parts[part].shape, *mesh, partBudget, errorText);
+    return quad && ObjExporter::exportQuadMesh(filePath, *quad, errorText);
+  }
+
   QString err;
   if (!buildTriangulation(exportQuads, &err))
   {
@@ -527,7 +593,16 @@ bool OcctViewerWidget::exportObjFile(const QString& filePath, bool exportQuads,
   }
 
   if (exportQuads && m_quadMesh)
-    return ObjExporter::exportQuadMesh(filePath, *m_quadMesh, errorText);
+  {
+    const bool written = ObjExporter::exportQuadMesh(filePath, *m_quadMesh, errorText);
+    // The quad mesh duplicates the vertex array and is only needed for this export.
+    if (m_memoryBudget.isLimited())
+    {
+      m_quadMesh.reset();
+      m_memoryBudget.release(MemoryBudget::kStageQuadMesh);
+    }
+    return written;
+  }
 
   if (m_triMesh)
     return ObjExporter::exportTriMesh(filePath, *m_triMesh, errorText);
@@ -536,3 +611,73 @@ bool OcctViewerWidget::exportObjFile(const QString& filePath, bool exportQuads,
     *errorText = QStringLiteral("网格数据不可用");
   return false;
 }
+
+bool OcctViewerWidget::exportCompressedFile(const QString& filePath, int positionBits, QString* errorText)
+{
+  const int part = selectedPartIndex();
+  if (part >= 0)
+  {
+    MemoryBudget partBudget = budgetForSelectedPart();
+    const std::shared_ptr<TriMesh> mesh = buildSelectedPartMesh(part, partBudget, errorText);
+    return mesh && MeshCodec::writeFile(filePath, *mesh, positionBits, errorText);
+  }
+
+  if (!buildTriangulation(false, errorText))
+    return false;
+  return MeshCodec::writeFile(filePath, *m_triMesh, positionBits, errorText);
+}
+
+// The face cache trades memory for re-meshing time, so a limited budget goes through MeshBuilder instead.
+std::shared_ptr<TriMesh> OcctViewerWidget::meshShape(const TopoDS_Shape& shape, MemoryBudget& budget,
+                                                     QString* errorText)
+{
+  if (budget.isLimited())
+  {
+    // Weld the triangulations the parts are displayed with. BRepMesh only re-meshes faces whose
+    // parameters changed since loading, and those replace the displayed ones, so recount them.
+    m_lastMeshStats = FaceMeshStats();
+    std::shared_ptr<TriMesh> mesh = MeshBuilder::buildTriMesh(shape, m_meshingParams, &budget, errorText);
+    for (ScenePart& part : m_parts)
+      part.triangulationBytes = MeshBuilder::triangulationBytes(part.shape);
+    m_memoryBudget.record(MemoryBudget::kStageFaceTriangulations, displayTriangulationBytes());
+    return mesh;
+  }
+
+  std::shared_ptr<TriMesh> mesh = m_faceCache.buildTriMesh(shape, m_meshingParams, &m_lastMeshStats);
+  budget.record(MemoryBudget::kStageTriMesh, MemoryBudget::bytesOf(*mesh));
+  budget.record(MemoryBudget::kStageFaceCache, m_faceCache.memoryBytes());
+  return mesh;
+}
+
+std::shared_ptr<QuadMesh> OcctViewerWidget::quadMeshShape(const TopoDS_Shape& shape, const TriMesh& triMesh,
+                                                          MemoryBudget& budget, QString* errorText)
+{
+  if (shape.IsNull() || budget.isLimited())
+    return MeshBuilder::buildQuadMesh(triMesh, &budget, errorText);
+
+  std::shared_ptr<QuadMesh> quad = m_faceCache.buildQuadMesh(shape, m_meshingParams, &m_lastMeshStats);
+  budget.record(MemoryBudget::kStageQuadMesh, MemoryBudget::bytesOf(*quad));
+  budget.record(MemoryBudget::kStageFaceCache, m_faceCache.memoryBytes());
+  return quad;
+}
+
+// A selected part is exported from a temporary mesh; it may use whatever the scene has not claimed.
+MemoryBudget OcctViewerWidget::budgetForSelectedPart() const
+{
+  if (!m_memoryBudget.isLimited())
+    return MemoryBudget();
+  return MemoryBudget(qMax<qint64>(1, m_memoryBudget.limitBytes() - m_memoryBudget.usedBytes()));
+}
+
+std::shared_ptr<TriMesh> OcctViewerWidget::buildSelectedPartMesh(int partIndex, MemoryBudget& budget,
+                                                                 QString* errorText)
+{
+  std::shared_ptr<TriMesh> mesh = meshShape(m_parts[partIndex].shape, budget, errorText);
+  if (mesh && (mesh->vertices.empty() || mesh->indices.empty()))
+  {
+    if (errorText)
+      *errorText = QStringLiteral("模型网格为空（可能是导入失败或无法三角化）");
+    return nullptr;
+  }
+  return mesh;
+}
@@ -0,0 +1,400 @@
+#include "Occt/ShapeHealer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Sewing.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Builder.hxx>
+#include <Bnd_Box.hxx>
+#include <ShapeExtend_Status.hxx>
+#include <ShapeFix_Face.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Face.hxx>
+
+#include "Occt/MeshBuilder.h"
+#include "Occt/ParallelFor.h"
+
+namespace
+{
+struct FaceBox
+{
+  double min[3] = {0.0, 0.0, 0.0};
+  double max[3] = {0.0, 0.0, 0.0};
+  bool valid = false;
+  // Open, infinite or non-finite bounds: the face is treated as overlapping every other face.
+  bool unbounded = false;
+};
+
+int findRoot(std::vector<int>& parent, int i)
+{
+  while (parent[i] != i)
+  {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+struct CellKey
+{
+  long long x = 0;
+  long long y = 0;
+  long long z = 0;
+  bool operator==(const CellKey& o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct CellKeyHash
+{
+  size_t operator()(const CellKey& k) const noexcept
+  {
+    const size_t hx = static_cast<size_t>(k.x) * 73856093ULL;
+    const size_t hy = static_cast<size_t>(k.y) * 19349663ULL;
+    const size_t hz = static_cast<size_t>(k.z) * 83492791ULL;
+    return hx ^ hy ^ hz;
+  }
+};
+
+bool boxesOverlap(const FaceBox& a, const FaceBox& b)
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (b.min[axis] > a.max[axis] || b.max[axis] < a.min[axis])
+      return false;
+  }
+  return true;
+}
+
+// Faces whose tolerance-inflated boxes overlap end up in the same cluster. Faces that could share a
+// sewn edge therefore never land in different clusters, and clusters can be sewn independently.
+// The flip side is that every connected part is one cluster, fixed and sewn serially: only disjoint parts
+// of a model heal in parallel. Faces of one cluster must not be fixed concurrently either, because
+// ShapeFix_Face updates the edges and vertices they share in place.
+// Candidate pairs come from a uniform grid sized to the typical face, so the pass stays close to linear
+// unless many faces crowd into the same cells; faces spanning many cells are tested against all others.
+std::vector<std::vector<int>> clusterFaces(const std::vector<FaceBox>& boxes)
+{
+  const int count = static_cast<int>(boxes.size());
+  std::vector<int> parent(count);
+  std::iota(parent.begin(), parent.end(), 0);
+
+  std::vector<double> extents;
+  extents.reserve(count);
+  for (const FaceBox& box : boxes)
+  {
+    if (box.valid && !box.unbounded)
+      extents.push_back(std::max({box.max[0] - box.min[0], box.max[1] - box.min[1], box.max[2] - box.min[2]}));
+  }
+
+  if (!extents.empty())
+  {
+    std::nth_element(extents.begin(), extents.begin() + extents.size() / 2, extents.end());
+    // Cell coordinates beyond this are not representable as integers and such faces are handled as large.
+    constexpr double kMaxCellCoordinate = 1e15;
+    const double cellSize = std::max(extents[extents.size() / 2], 1e-9);
+    constexpr double kMaxCellsPerFace = 64.0;
+
+    std::unordered_map<CellKey, std::vector<int>, CellKeyHash> cells;
+    std::vector<int> large;
+    for (int i = 0; i < count; ++i)
+    {
+      const FaceBox& box = boxes[i];
+      if (!box.valid)
+        continue;
+      double cellMin[3];
+      double cellMax[3];
+      bool representable = !box.unbounded;
+      for (int axis = 0; axis < 3 && representable; ++axis)
+      {
+        cellMin[axis] = std::floor(box.min[axis] / cellSize);
+        cellMax[axis] = std::floor(box.max[axis] / cellSize);
+        representable = std::abs(cellMin[axis]) < kMaxCellCoordinate && std::abs(cellMax[axis]) < kMaxCellCoordinate;
+      }
+      if (!representable
+          || (cellMax[0] - cellMin[0] + 1) * (cellMax[1] - cellMin[1] + 1) * (cellMax[2] - cellMin[2] + 1)
+               > kMaxCellsPerFace)
+      {
+        large.push_back(i);
+        continue;
+      }
+      long long lo[3];
+      long long hi[3];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        lo[axis] = static_cast<long long>(cellMin[axis]);
+        hi[axis] = static_cast<long long>(cellMax[axis]);
+      }
+      for (long long x = lo[0]; x <= hi[0]; ++x)
+        for (long long y = lo[1]; y <= hi[1]; ++y)
+          for (long long z = lo[2]; z <= hi[2]; ++z)
+            cells[CellKey{x, y, z}].push_back(i);
+    }
+
+    const auto unite = [&](int a, int b) {
+      const int rootA = findRoot(parent, a);
+      const int rootB = findRoot(parent, b);
+      if (rootA != rootB && (boxes[a].unbounded || boxes[b].unbounded || boxesOverlap(boxes[a], boxes[b])))
+        parent[rootA] = rootB;
+    };
+    for (const auto& cell : cells)
+    {
+      const std::vector<int>& members = cell.second;
+      for (size_t i = 0; i < members.size(); ++i)
+        for (size_t j = i + 1; j < members.size(); ++j)
+          unite(members[i], members[j]);
+    }
+    for (const int i : large)
+    {
+      for (int j = 0; j < count; ++j)
+      {
+        if (j != i && boxes[j].valid)
+          unite(i, j);
+      }
+    }
+  }
+
+  std::vector<int> clusterOfRoot(count, -1);
+  std::vector<std::vector<int>> clusters;
+  for (int i = 0; i < count; ++i)
+  {
+    const int root = findRoot(parent, i);
+    if (clusterOfRoot[root] < 0)
+    {
+      clusterOfRoot[root] = static_cast<int>(clusters.size());
+      clusters.emplace_back();
+    }
+    clusters[clusterOfRoot[root]].push_back(i);
+  }
+
+  std::sort(clusters.begin(), clusters.end(),
+            [](const std::vector<int>& a, const std::vector<int>& b) { return a.size() > b.size(); });
+  return clusters;
+}
+
+QString healedCachePath(const QString& filePath, double tolerance)
+{
+  const QFileInfo info(filePath);
+  const QString key = QStringLiteral("%1|%2|%3|%4")
+                        .arg(info.canonicalFilePath())
+                        .arg(info.size())
+                        .arg(info.lastModified().toMSecsSinceEpoch())
+                        .arg(tolerance, 0, 'g', 17);
+  const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+  const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/healed");
+  return dir + QLatin1Char('/') + QString::fromLatin1(hash) + QStringLiteral(".brep");
+}
+} // namespace
+
+TopoDS_Shape ShapeHealer::heal(const TopoDS_Shape& shape, double tolerance, HealingReport* report)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  std::vector<TopoDS_Face> faces;
+  for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+    faces.push_back(TopoDS::Face(exp.Current()));
+
+  HealingReport local;
+  local.faceCount = static_cast<int>(faces.size());
+  if (faces.empty())
+  {
+    local.elapsedMs = timer.elapsed();
+    if (report)
+      *report = local;
+    return shape;
+  }
+
+  std::vector<FaceBox> boxes(faces.size());
+  parallelFor(faces.size(), 64, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      Bnd_Box box;
+      BRepBndLib::Add(faces[i], box, false);
+      if (box.IsVoid())
+        continue;
+      box.Enlarge(tolerance);
+      box.Get(boxes[i].min[0], boxes[i].min[1], boxes[i].min[2], boxes[i].max[0], boxes[i].max[1], boxes[i].max[2]);
+      boxes[i].valid = true;
+      boxes[i].unbounded = box.IsOpen();
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        // Infinite surfaces report bounds around Precision::Infinite() (1e100) rather than an open box.
+        if (!(std::abs(boxes[i].min[axis]) < 1e50) || !(std::abs(boxes[i].max[axis]) < 1e50))
+          boxes[i].unbounded = true;
+      }
+    }
+  });
+
+  const std::vector<std::vector<int>> clusters = clusterFaces(boxes);
+  local.clusterCount = static_cast<int>(clusters.size());
+
+  struct ClusterResult
+  {
+    TopoDS_Shape shape;
+    int fixedFaces = 0;
+    int failedFaces = 0;
+    int freeEdges = 0;
+    int multipleEdges = 0;
+    int degeneratedShapes = 0;
+    int deletedFaces = 0;
+    bool failed = false;
+  };
+  std::vector<ClusterResult> results(clusters.size());
+
+  // Clusters are sorted largest first and handed out one at a time, so big clusters start early.
+  std::atomic<size_t> nextCluster{0};
+  parallelFor(std::min(parallelWorkerCount(), clusters.size()), 1, [&](size_t, size_t) {
+    for (size_t c = nextCluster++; c < clusters.size(); c = nextCluster++)
+    {
+      ClusterResult& result = results[c];
+      // Serial within the cluster: fixing one face updates the edges and vertices it shares with others.
+      // A face ShapeFix throws on is kept as it was read.
+      std::vector<TopoDS_Face> fixed;
+      fixed.reserve(clusters[c].size());
+      for (const int faceIndex : clusters[c])
+      {
+        try
+        {
+          ShapeFix_Face fixer(faces[faceIndex]);
+          fixer.SetPrecision(tolerance);
+          fixer.SetMaxTolerance(tolerance * 10.0);
+          fixer.Perform();
+          if (fixer.Status(ShapeExtend_DONE))
+            ++result.fixedFaces;
+          fixed.push_back(fixer.Face());
+        }
+        catch (const Standard_Failure&)
+        {
+          ++result.failedFaces;
+          fixed.push_back(faces[faceIndex]);
+        }
+      }
+
+      if (fixed.size() == 1)
+      {
+        result.shape = fixed.front();
+        continue;
+      }
+
+      try
+      {
+        BRepBuilderAPI_Sewing sewing(tolerance);
+        for (const TopoDS_Face& face : fixed)
+          sewing.Add(face);
+        sewing.Perform();
+        result.shape = sewing.SewedShape();
+        result.freeEdges = sewing.NbFreeEdges();
+        result.multipleEdges = sewing.NbMultipleEdges();
+        result.degeneratedShapes = sewing.NbDegeneratedShapes();
+        result.deletedFaces = sewing.NbDeletedFaces();
+      }
+      catch (const Standard_Failure&)
+      {
+        // One bad cluster should not cost the rest of the model; keep its faces as they were read.
+        BRep_Builder builder;
+        TopoDS_Compound unhealed;
+        builder.MakeCompound(unhealed);
+        for (const int faceIndex : clusters[c])
+          builder.Add(unhealed, faces[faceIndex]);
+        const int failedFaces = result.failedFaces;
+        result = ClusterResult();
+        result.shape = unhealed;
+        result.failedFaces = failedFaces;
+        result.failed = true;
+      }
+    }
+  });
+
+  BRep_Builder builder;
+  TopoDS_Compound compound;
+  builder.MakeCompound(compound);
+  for (const ClusterResult& result : results)
+  {
+    if (result.shape.IsNull())
+      continue;
+    builder.Add(compound, result.shape);
+    local.fixedFaces += result.fixedFaces;
+    local.failedFaces += result.failedFaces;
+    local.failedClusters += result.failed ? 1 : 0;
+    local.freeEdges += result.freeEdges;
+    local.multipleEdges += result.multipleEdges;
+    local.degeneratedShapes += result.degeneratedShapes;
+    local.deletedFaces += result.deletedFaces;
+  }
+
+  for (TopExp_Explorer exp(shape, TopAbs_EDGE, TopAbs_FACE); exp.More(); exp.Next())
+    builder.Add(compound, exp.Current());
+
+  local.elapsedMs = timer.elapsed();
+  if (report)
+    *report = local;
+  return compound;
+}
+
+bool ShapeHealer::readHealedIgsFile(const QString& filePath, double tolerance, TopoDS_Shape& shape,
+                                    HealingReport* report, QString* errorText)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  const QString cachePath = healedCachePath(filePath, tolerance);
+  if (QFileInfo::exists(cachePath))
+  {
+    BRep_Builder builder;
+    TopoDS_Shape cached;
+    if (BRepTools::Read(cached, cachePath.toUtf8().constData(), builder) && !cached.IsNull())
+    {
+      shape = cached;
+      if (report)
+      {
+        *report = HealingReport();
+        report->fromCache = true;
+        report->elapsedMs = timer.elapsed();
+      }
+      return true;
+    }
+  }
+
+  TopoDS_Shape raw;
+  if (!MeshBuilder::readIgsFile(filePath, raw, errorText))
+    return false;
+
+  HealingReport local;
+  shape = heal(raw, tolerance, &local);
+  if (report)
+    *report = local;
+  // Partially healed results are not cached, so the next import tries the failed faces and clusters again.
+  if (local.failedFaces > 0 || local.failedClusters > 0)
+    return true;
+
+  // QSaveFile writes to a unique temporary file and renames it on commit, so concurrent imports of the
+  // same file never see each other's partial output.
+  std::ostringstream stream;
+  BRepTools::Write(shape, stream);
+  const std::string bytes = stream.str();
+  QDir().mkpath(QFileInfo(cachePath).absolutePath());
+  QSaveFile file(cachePath);
+  if (stream && file.open(QIODevice::WriteOnly))
+  {
+    file.write(bytes.data(), static_cast<qint64>(bytes.size()));
+    file.commit();
+  }
+  return true;
+}
@@ -1,9 +1,13 @@
 #include <QApplication>
 
+#include "App/CommandLine.h"
 #include "App/MainWindow.h"
 
 int main(int argc, char* argv[])
 {
+  if (CommandLine::isBatchInvocation(argc, argv))
+    return CommandLine::run(argc, argv);
+
   QApplication app(argc, argv);
 
   MainWindow w;
@@ -12,4 +16,3 @@ int main(int argc, char* argv[])
 
   return app.exec();
 }
-